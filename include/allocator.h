@@ -2,13 +2,29 @@
 #define ALLOCATOR_H
 
 #include "memory_block.h"
+#include "block_pool.h"
+#include "block_table.h"
+#include "buddy_allocator.h"
 #include <string>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <utility>
 
 // Allocation strategy enumeration
 enum class AllocationStrategy {
     FIRST_FIT,
     BEST_FIT,
-    WORST_FIT
+    WORST_FIT,
+    NEXT_FIT,   // First fit resuming after the previous allocation
+    TLSF,       // Two-level segregated fit, O(1) good fit (list backend only)
+    BUDDY       // Binary buddy system (see buddy_allocator.h)
+};
+
+// Block metadata storage
+enum class BlockBackend {
+    LIST,   // Doubly linked MemoryBlock list with free-block indexes
+    TABLE   // Contiguous structure-of-arrays block table
 };
 
 // Statistics for memory allocation
@@ -20,21 +36,78 @@ struct AllocationStats {
     size_t num_deallocations;
     size_t allocation_failures;
     double external_fragmentation;  // Percentage
+    double internal_fragmentation;  // Percentage of used memory not requested
+    size_t node_pool_high_water;    // Peak number of block nodes (or table slots) in use
     
     AllocationStats() 
         : total_memory(0), used_memory(0), free_memory(0),
           num_allocations(0), num_deallocations(0), 
-          allocation_failures(0), external_fragmentation(0.0) {}
+          allocation_failures(0), external_fragmentation(0.0),
+          internal_fragmentation(0.0), node_pool_high_water(0) {}
 };
 
 // Memory Allocator class - manages memory allocation/deallocation
 class Allocator {
 private:
     MemoryBlock* head;           // Head of the block list
+    MemoryBlock* rover;          // Next fit roving pointer: block after the last allocation
     size_t total_size;           // Total memory size
     AllocationStrategy strategy; // Current allocation strategy
+    BlockBackend backend;        // Block metadata storage in use
     int next_block_id;           // Next block ID to assign
+    size_t requested_memory;     // Bytes requested by live allocations
+    bool verbose;                // Print a line per init/allocate/free
     AllocationStats stats;       // Statistics
+    BlockPool pool;              // Storage for block list nodes
+    BlockTable table;            // Block storage for the TABLE backend
+    BuddyAllocator buddy;        // Engine for the BUDDY strategy
+    
+    // Two-level segregated free lists (TLSF layout). The first level splits
+    // sizes by power of two, the second splits each power-of-two range into
+    // SL_COUNT equal classes. Bitmaps mark the non-empty lists.
+    static const int SL_BITS = 4;
+    static const int SL_COUNT = 1 << SL_BITS;
+    static const int FL_COUNT = 64 - SL_BITS + 1;
+    MemoryBlock* free_lists[FL_COUNT][SL_COUNT];
+    uint64_t fl_bitmap;               // Bit fl set if any list in level fl is non-empty
+    uint32_t sl_bitmap[FL_COUNT];     // Bit sl set if free_lists[fl][sl] is non-empty
+    
+    size_t free_count;                // Blocks in the segregated lists
+    
+    // Free blocks ordered by (size, address) for best/worst fit lookups.
+    // Only kept while one of those strategies is active, so the other
+    // strategies free and split blocks without touching a tree.
+    std::map<std::pair<size_t, size_t>, MemoryBlock*> free_by_size;
+    
+    // Free blocks ordered by (size class, address) for first fit, so each
+    // class yields its lowest address directly. Only kept while first fit
+    // is active.
+    std::map<std::pair<int, size_t>, MemoryBlock*> free_by_class;
+    
+    // Handle table: block_table[id] is the allocated block with that ID,
+    // nullptr once freed. IDs are handed out densely from 1.
+    std::vector<MemoryBlock*> block_table;
+    
+    // Two-level class (fl, sl) holding a block of the given size
+    static void mapping(size_t size, int& fl, int& sl);
+    
+    // Add/remove a free block to/from its size-class list and the size tree
+    void insertFreeBlock(MemoryBlock* block);
+    void removeFreeBlock(MemoryBlock* block);
+    
+    // Whether the current strategy searches free_by_size / free_by_class
+    bool usesSizeTree() const;
+    bool usesClassTree() const;
+    
+    // Refill the trees the current strategy uses from the block list and
+    // empty the others
+    void rebuildSearchTrees();
+    
+    // Largest block in the segregated lists (list backend)
+    size_t largestFreeInLists() const;
+    
+    // Release all blocks and empty the free lists and handle table
+    void releaseBlocks();
     
     // Find a free block using current strategy
     MemoryBlock* findFreeBlock(size_t size);
@@ -43,22 +116,32 @@ private:
     MemoryBlock* firstFit(size_t size);
     MemoryBlock* bestFit(size_t size);
     MemoryBlock* worstFit(size_t size);
+    MemoryBlock* nextFit(size_t size);
+    MemoryBlock* tlsfFit(size_t size);
     
-    // Coalesce adjacent free blocks
-    void coalesce(MemoryBlock* block);
+    // Find, split and mark a block for a new allocation; false if none fits
+    bool placeInList(size_t size, int id, size_t& address);
+    bool placeInTable(size_t size, int id, size_t& address);
     
-    // Update statistics
-    void updateStats();
+    // Free an allocated list block and coalesce it; returns freed size or 0
+    size_t releaseFromList(int block_id);
+    
+    // Coalesce adjacent free blocks, returns the merged block
+    MemoryBlock* coalesce(MemoryBlock* block);
+    
+    // Fill in derived statistics (fragmentation) from the running totals.
+    // Done on demand by getStats so allocate and free stay cheap.
+    void computeDerivedStats(AllocationStats& out) const;
 
 public:
     Allocator();
     ~Allocator();
     
-    // Initialize memory with given size
-    bool initMemory(size_t size);
+    // Initialize memory with given size and block storage backend
+    bool initMemory(size_t size, BlockBackend blockBackend = BlockBackend::LIST);
     
-    // Set allocation strategy
-    void setStrategy(AllocationStrategy strat);
+    // Set allocation strategy; switching to or from buddy needs an empty heap
+    bool setStrategy(AllocationStrategy strat);
     void setStrategy(const std::string& strategyName);
     
     // Allocate memory, returns block ID or -1 on failure
@@ -76,6 +159,12 @@ public:
     // Get strategy name
     std::string getStrategyName() const;
     
+    // Turn per-operation output of initMemory/allocate/free on or off
+    void setVerbose(bool on);
+    
+    // Get block storage backend name
+    std::string getBackendName() const;
+    
     // Check if memory is initialized
     bool isInitialized() const;
 };
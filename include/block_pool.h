@@ -0,0 +1,41 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include "memory_block.h"
+#include <vector>
+
+// Pool of MemoryBlock nodes carved out of fixed-size chunks.
+// Destroyed nodes go on a free list and are reused by the next create,
+// so splitting and merging blocks does not touch the system heap.
+class BlockPool {
+private:
+    static const size_t CHUNK_NODES = 256;  // Nodes per chunk
+    
+    std::vector<MemoryBlock*> chunks;  // Raw storage for CHUNK_NODES nodes each
+    MemoryBlock* free_nodes;           // Recycled nodes, linked through 'next'
+    size_t chunk_index;                // Chunk currently being carved
+    size_t chunk_used;                 // Nodes carved from that chunk
+    size_t in_use;                     // Nodes currently handed out
+    size_t high_water;                 // Peak of in_use since last release
+    
+public:
+    BlockPool();
+    ~BlockPool();
+    
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+    
+    // Construct a node in pooled storage
+    MemoryBlock* create(size_t addr, size_t sz, bool free = true, int id = -1);
+    
+    // Return a node to the pool
+    void destroy(MemoryBlock* block);
+    
+    // Release every node at once; chunks are kept for reuse
+    void releaseAll();
+    
+    size_t inUse() const { return in_use; }
+    size_t highWater() const { return high_water; }
+};
+
+#endif // BLOCK_POOL_H
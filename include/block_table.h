@@ -0,0 +1,76 @@
+#ifndef BLOCK_TABLE_H
+#define BLOCK_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Contiguous block table - alternative to the MemoryBlock linked list.
+// Block metadata is stored structure-of-arrays style: each field lives in
+// its own vector indexed by slot, and address order is kept with index
+// links. Fit searches stream over the size/free arrays instead of
+// chasing pointers. Slots released by merges are recycled.
+class BlockTable {
+private:
+    std::vector<size_t> addresses;   // Starting address per slot
+    std::vector<size_t> sizes;       // Size per slot
+    std::vector<uint8_t> free_flags; // 1 if the slot is a free block
+    std::vector<int> ids;            // Block ID per slot (-1 if free)
+    std::vector<int> next_slots;     // Next slot in address order
+    std::vector<int> prev_slots;     // Previous slot in address order
+    
+    std::vector<int> unused_slots;   // Slots released by merges
+    std::vector<int> id_slots;       // Block ID -> slot (NONE once freed)
+    int head_slot;                   // Lowest-addressed block
+    int rover_slot;                  // Next fit roving cursor: slot after the last allocation
+    size_t free_count;               // Number of free blocks
+    
+    // Get a slot for a new block, reusing released slots first
+    int newSlot(size_t addr, size_t sz);
+    
+    // Drop a slot from the address order and recycle it
+    void releaseSlot(int slot);
+
+public:
+    static const int NONE = -1;
+    
+    BlockTable();
+    
+    // Reset to a single free block covering [0, size)
+    void reset(size_t size);
+    
+    // Drop all blocks
+    void clear();
+    
+    // Fit searches, return a slot or NONE
+    int firstFit(size_t size) const;
+    int bestFit(size_t size) const;
+    int worstFit(size_t size) const;
+    int nextFit(size_t size) const;
+    
+    // Mark a free slot as allocated with the given ID, splitting off the tail
+    void allocate(int slot, size_t size, int id);
+    
+    // Free the block with the given ID and merge it with free neighbours.
+    // Returns the freed size, or 0 if no such block is allocated.
+    size_t release(int id);
+    
+    // Largest free block size (streams the size array)
+    size_t largestFree() const;
+    size_t freeBlockCount() const { return free_count; }
+    
+    // Number of slots ever needed since the last reset
+    size_t slotCount() const { return sizes.size(); }
+    
+    bool isInitialized() const { return head_slot != NONE; }
+    
+    // Slot accessors for walking the table in address order
+    int head() const { return head_slot; }
+    int next(int slot) const { return next_slots[slot]; }
+    size_t address(int slot) const { return addresses[slot]; }
+    size_t size(int slot) const { return sizes[slot]; }
+    bool isFree(int slot) const { return free_flags[slot] != 0; }
+    int id(int slot) const { return ids[slot]; }
+};
+
+#endif // BLOCK_TABLE_H
@@ -0,0 +1,77 @@
+#ifndef BUDDY_ALLOCATOR_H
+#define BUDDY_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+// Binary buddy allocator.
+// Memory is carved into power-of-two blocks aligned to their size. Each
+// order has a free list, so allocation splits down from the smallest
+// large-enough order and free merges with the buddy (address XOR size)
+// while it is free - both O(log N). Block records are kept in a hash
+// map keyed by block start, so metadata grows with the number of blocks,
+// not with the size of memory.
+// Sizes that are not a power of two are covered by one top-level block
+// per set bit; any tail below the minimum block size is unusable.
+class BuddyAllocator {
+public:
+    static const int MIN_ORDER = 4;   // Smallest block is 16 bytes
+    static const size_t NONE = (size_t)-1;
+
+private:
+    size_t managed_size;              // Bytes covered by buddy blocks
+    int max_order;                    // Largest block order in use
+    size_t free_count;                // Number of free blocks
+    
+    size_t high_water;                // Most block records held at once
+    
+    struct Block {
+        int order;
+        int id;                       // -1 if free
+        size_t requested;             // Bytes requested, 0 if free
+        size_t next_free;             // Free list links (block addresses)
+        size_t prev_free;
+    };
+    std::unordered_map<size_t, Block> blocks;       // Block start -> record
+    
+    std::vector<size_t> free_heads;                 // Free list head per order
+    std::vector<size_t> id_addresses;               // Block ID -> address (NONE once freed)
+    
+    bool isFreeAt(int order, size_t address) const;
+    void pushFree(int order, size_t address);
+    void removeFree(int order, size_t address);
+
+public:
+    BuddyAllocator();
+    
+    // Set up buddy blocks covering [0, size)
+    void reset(size_t size);
+    
+    // Drop all blocks
+    void clear();
+    
+    // Allocate a block for 'size' bytes under the given ID. On success
+    // sets the block address and the granted (power-of-two) size.
+    bool allocate(size_t size, int id, size_t& address, size_t& granted);
+    
+    // Free the block with the given ID and merge it with free buddies.
+    // Returns the granted size (0 if not allocated) and sets the size
+    // originally requested.
+    size_t release(int id, size_t& requestedSize);
+    
+    size_t largestFree() const;
+    size_t freeBlockCount() const { return free_count; }
+    size_t managedSize() const { return managed_size; }
+    size_t highWater() const { return high_water; }
+    bool isInitialized() const { return managed_size > 0; }
+    
+    // Block accessors for walking memory in address order; 'address'
+    // must be the start of a block
+    size_t blockSize(size_t address) const;
+    bool isFree(size_t address) const;
+    int blockId(size_t address) const;
+};
+
+#endif // BUDDY_ALLOCATOR_H
@@ -2,25 +2,29 @@
 #define CACHE_H
 
 #include <vector>
-#include <list>
 #include <unordered_map>
 #include <string>
+#include <cstdint>
+#include "trace.h"
 
 // Cache replacement policy
 enum class ReplacementPolicy {
-    FIFO,   // First In First Out
-    LRU     // Least Recently Used
+    FIFO,       // First In First Out
+    LRU,        // Least Recently Used
+    PLRU,       // Tree pseudo-LRU (associativity - 1 bits per set)
+    BIT_PLRU,   // MRU-bit pseudo-LRU (one bit per way)
+    SRRIP,      // Static re-reference interval prediction
+    BRRIP,      // Bimodal RRIP (scan resistant)
+    DRRIP,      // Dynamic RRIP, SRRIP or BRRIP picked by set dueling
+    OPT         // Belady's optimal, needs a trace (offline evaluation)
 };
 
-// Single cache line
-struct CacheLine {
-    bool valid;
-    bool dirty;          // Modified bit - true if written to
-    size_t tag;
-    size_t last_access;  // For LRU
-    
-    CacheLine() : valid(false), dirty(false), tag(0), last_access(0) {}
-};
+// Policy name for display ("LRU", "Tree-PLRU", ...)
+std::string policyName(ReplacementPolicy policy);
+
+// Parse a policy as typed by the user ("lru", "fifo", "plru", "bitplru",
+// "srrip", "brrip", "drrip", "opt"); returns false if the name is unknown
+bool parsePolicy(const std::string& text, ReplacementPolicy& policy);
 
 // Statistics for a single cache level
 struct CacheStats {
@@ -37,6 +41,19 @@ struct CacheStats {
     }
 };
 
+// Aggregate result of a batch of accesses through the hierarchy
+struct BatchResult {
+    size_t accesses;
+    size_t memory_accesses;    // Accesses that missed every level
+    size_t total_cycles;       // Sum of the access times of the batch
+    
+    BatchResult() : accesses(0), memory_accesses(0), total_cycles(0) {}
+    
+    double averageCycles() const {
+        return accesses > 0 ? (double)total_cycles / accesses : 0.0;
+    }
+};
+
 // Single cache level (L1, L2, etc.)
 class CacheLevel {
 private:
@@ -47,12 +64,66 @@ private:
     size_t num_sets;
     size_t num_lines;
     
-    std::vector<std::vector<CacheLine>> sets;
-    std::vector<std::list<size_t>> fifo_queues;  // For FIFO replacement
+    // Address decoding, precomputed from the geometry
+    size_t offset_bits;       // log2(block_size)
+    size_t index_bits;        // log2(num_sets)
+    size_t index_mask;        // num_sets - 1
+    
+    // Flat tag store: line (set, way) lives at index set * associativity + way
+    std::vector<size_t> tags;
+    std::vector<uint64_t> valid_bits;     // One bit per line
+    std::vector<uint64_t> dirty_bits;     // One bit per line - modified since fill
+    // FIFO state: per set, the way filled longest ago. Invalid ways are
+    // filled lowest first and lines are never invalidated, so the fill
+    // order is always way 0, 1, 2, ... and a round-robin pointer replaces
+    // a queue.
+    std::vector<uint16_t> fifo_next;
+    
+    // LRU recency state, constant time to update and to pick a victim.
+    // Up to 8 ways: one 8x8 bit matrix per set; touching way w sets row w
+    // and clears column w, so the LRU way is the one with an all-zero row.
+    // More ways: a recency list per set linked through per-line indexes,
+    // most recently used at the head and the victim at the tail.
+    static const size_t LRU_MATRIX_WAYS = 8;
+    std::vector<uint64_t> lru_matrix;     // One matrix per set
+    std::vector<uint16_t> lru_prev;       // Per line, towards the MRU end
+    std::vector<uint16_t> lru_next;       // Per line, towards the LRU end
+    std::vector<uint16_t> lru_head;       // Per set, most recently used way
+    std::vector<uint16_t> lru_tail;       // Per set, least recently used way
+    
+    // Pseudo-LRU state, one word per set.
+    // Tree-PLRU: associativity - 1 node bits in heap order, each pointing
+    // towards the less recently used half (0 = left, 1 = right).
+    // Bit-PLRU: one MRU bit per way, cleared (except the newest) once all
+    // are set; the victim is the lowest way with a clear bit.
+    std::vector<uint64_t> plru_bits;
+    size_t plru_levels;                   // log2(associativity) for the tree
+    
+    // RRIP state: a 2-bit re-reference prediction value (RRPV) per line.
+    // Hits predict near re-reference (0); SRRIP fills at long (2), BRRIP
+    // at distant (3) except for one fill in every BRRIP_LONG_INTERVAL.
+    // The victim is the lowest way at 3, ageing the whole set until one is.
+    // DRRIP dedicates leader sets to each and follows the policy whose
+    // leaders miss less, tracked by a 10-bit saturating PSEL counter.
+    // One set in 32 leads for each policy (at least one, at most 32), so
+    // DRRIP needs 4 sets to leave followers.
+    static const uint8_t RRPV_MAX = 3;
+    static const size_t BRRIP_LONG_INTERVAL = 32;
+    static const uint16_t PSEL_MAX = 1023;
+    std::vector<uint8_t> rrpv;            // One per line
+    size_t brrip_fills;                   // Throttle counter for BRRIP fills
+    size_t leader_stride;                 // Sets per leader group (power of two)
+    uint16_t psel;                        // >= 512: followers use BRRIP
+    
+    // OPT state: each line holds the trace position of its next use, and
+    // the victim is the line used furthest in the future (lowest way on
+    // ties). Outside a trace nothing is known, so every line gets NEVER.
+    // Each level looks ahead over the whole trace at its own block size.
+    std::vector<size_t> next_use;         // One per line
+    std::vector<size_t> trace_next_use;   // Per trace position, while replaying
     
     ReplacementPolicy policy;
     CacheStats stats;
-    size_t access_counter;
     size_t access_latency;  // Cycles to access this cache level
     
     // Get set index from address
@@ -63,15 +134,80 @@ private:
     
     // Find a line to evict using current policy
     size_t findVictim(size_t set_index);
+    
+    // Record a hit on / fill of a way in the replacement state
+    void touch(size_t set_index, size_t way);
+    void fill(size_t set_index, size_t way);
+    
+    // Mark a way as most recently used / get the least recently used way
+    void touchLru(size_t set_index, size_t way);
+    size_t lruVictim(size_t set_index) const;
+    
+    // Pseudo-LRU equivalents
+    void touchPlru(size_t set_index, size_t way);
+    size_t plruVictim(size_t set_index) const;
+    
+    // RRIP: insertion for a miss, and the victim (ageing the set)
+    void fillRrip(size_t set_index, size_t way);
+    size_t rripVictim(size_t set_index);
+    
+    // OPT: line used furthest in the future
+    size_t optVictim(size_t set_index) const;
+    
+    // Body of access(), counting into 'counters' instead of stats
+    bool lookup(size_t address, bool isWrite, size_t position, CacheStats& counters,
+                size_t* writeback = nullptr);
 
 public:
+    // Trace position of an access made outside a trace / next use of a
+    // block that is never referenced again
+    static const size_t NO_POSITION = (size_t)-1;
+    static const size_t NEVER = (size_t)-1;
+    
+    // No dirty line was evicted (see access)
+    static const size_t NO_WRITEBACK = (size_t)-1;
+    
+    // Check that a geometry can be decoded with shifts and masks: block
+    // size and set count must be powers of two, and associativity must fit
+    // the 16-bit way indexes (64 ways for the PLRU policies, and a power
+    // of two for Tree-PLRU). Sets 'error' if not.
+    static bool validateGeometry(size_t cacheSize, size_t blockSize,
+                                 size_t assoc, ReplacementPolicy pol,
+                                 std::string& error);
+    
+    // Geometry must pass validateGeometry
     CacheLevel(const std::string& levelName, size_t cacheSize, 
                size_t blockSize, size_t assoc, ReplacementPolicy pol,
                size_t latency = 1);
     
     // Access cache, returns true on hit, false on miss
     // isWrite: if true, marks the line as dirty (write-back policy)
-    bool access(size_t address, bool isWrite = false);
+    // position: index of the access in the trace being replayed (OPT);
+    //           a hit with NO_POSITION keeps the line's next use
+    // writeback: if given, set to the block address of a dirty line
+    //            evicted by a miss, or NO_WRITEBACK
+    bool access(size_t address, bool isWrite = false, size_t position = NO_POSITION,
+                size_t* writeback = nullptr);
+    
+    // OPT only: compute the next use of every trace position with one
+    // backward pass, before replaying 'trace'; endTrace frees it again
+    void beginTrace(const std::vector<TraceRecord>& trace);
+    void endTrace();
+    
+    // Parallel replay: sets evolve independently, so threads can each own
+    // a contiguous run of sets. Runs must be multiples of
+    // shardGranularity() sets so no two threads write the same bitset
+    // word. BRRIP and DRRIP share state between sets and cannot be split.
+    bool hasGlobalState() const;
+    size_t shardGranularity() const;
+    size_t getNumSets() const { return num_sets; }
+    
+    // Access the records that map to sets [first_set, end_set), counting
+    // into 'counters'; addStats folds such counters into the level stats
+    void accessShard(const TraceRecord* records, size_t count,
+                     size_t first_set, size_t end_set,
+                     size_t first_position, CacheStats& counters);
+    void addStats(const CacheStats& counters);
     
     // Get access latency for this level
     size_t getLatency() const { return access_latency; }
@@ -85,6 +221,9 @@ public:
     // Get cache info string
     std::string getInfo() const;
     
+    // DRRIP: the policy followers use and the PSEL counter; empty otherwise
+    std::string getDuelInfo() const;
+    
     std::string getName() const { return name; }
 };
 
@@ -95,20 +234,53 @@ private:
     bool initialized;
     size_t total_access_time;    // Cumulative access time across all accesses
     size_t memory_latency;       // Latency for main memory access
+    bool verbose;                // Report added levels, accesses and resets
+    
+    // Send one access down the hierarchy and add its cycles to
+    // total_access_time. Returns the index of the level that hit
+    // (levels.size() if it went to memory) and the cycles taken,
+    // including writeback_time spent on dirty evictions.
+    size_t accessLevels(size_t address, bool isWrite, size_t position,
+                        size_t& access_time, size_t& writeback_time);
+    
+    // Write a dirty block evicted from the level above into level
+    // 'index' (memory past the last level), following any dirty line it
+    // evicts in turn. Returns the cycles spent.
+    size_t writeBack(size_t index, size_t address);
 
 public:
     CacheSimulator();
     ~CacheSimulator();
     
-    // Add a cache level with configurable latency
-    void addLevel(const std::string& name, size_t size, 
+    // Add a cache level with configurable latency; returns false (and adds
+    // nothing) if the geometry is invalid
+    bool addLevel(const std::string& name, size_t size, 
                   size_t blockSize, size_t associativity,
                   ReplacementPolicy policy, size_t latency = 1);
     
     // Access memory address through cache hierarchy (verbose output)
-    // isWrite: if true, marks the line as dirty (write-back policy)
+    // isWrite: if true, marks the L1 line as dirty (write-back policy)
     void access(size_t address, bool isWrite = false);
     
+    // Access 'count' records with no output, updating level stats and
+    // total_access_time. first_position is the trace position of
+    // records[0] when replaying a trace prepared for OPT.
+    BatchResult accessBatch(const TraceRecord* records, size_t count,
+                            size_t first_position = CacheLevel::NO_POSITION);
+    
+    // Same as accessBatch for a single-level hierarchy, with the sets
+    // sharded across 'threads' threads; results are identical to the
+    // serial path. Returns false (after printing an error) for more than
+    // one level or a policy with state shared between sets.
+    bool accessBatchParallel(const TraceRecord* records, size_t count,
+                             size_t threads, BatchResult& result,
+                             size_t first_position = CacheLevel::NO_POSITION);
+    
+    // Replay a whole trace without per-access output
+    BatchResult runTrace(const std::vector<TraceRecord>& trace);
+    bool runTraceParallel(const std::vector<TraceRecord>& trace, size_t threads,
+                          BatchResult& result);
+    
     // Print statistics for all levels
     void printStats() const;
     
@@ -119,6 +291,12 @@ public:
     void resetStats();
     
     bool isInitialized() const { return initialized; }
+    
+    // Level access for reporting
+    size_t getLevelCount() const { return levels.size(); }
+    const CacheLevel& getLevel(size_t index) const { return *levels[index]; }
+    
+    void setVerbose(bool on) { verbose = on; }
 };
 
 #endif // CACHE_H
@@ -0,0 +1,40 @@
+#ifndef CACHE_SWEEP_H
+#define CACHE_SWEEP_H
+
+#include "cache.h"
+#include "trace.h"
+#include <vector>
+#include <string>
+#include <ostream>
+
+// One cache level of a sweep configuration
+struct LevelConfig {
+    size_t size;
+    size_t block_size;
+    size_t associativity;
+    ReplacementPolicy policy;
+    size_t latency;
+};
+
+// One hierarchy to simulate; levels are named L1, L2, ... in order
+struct SweepConfig {
+    std::string text;                   // As written in the config file
+    std::vector<LevelConfig> levels;
+};
+
+// Load sweep configurations, one hierarchy per line. Each level is
+// "<size> <block> <assoc> <policy> <latency>", levels separated by '/':
+//   256 16 4 lru 1 / 1024 32 8 fifo 10
+// Blank lines and lines starting with '#' are skipped. Returns false
+// (after printing the offending line) if any line is invalid.
+bool loadSweepConfigs(const std::string& path, std::vector<SweepConfig>& configs);
+
+// Simulate every configuration over the same trace on a pool of
+// 'threads' threads, each with its own CacheSimulator, then write one
+// CSV row per configuration (in file order) with the hit ratio and
+// access time of each level.
+void runSweep(const std::vector<SweepConfig>& configs,
+              const std::vector<TraceRecord>& trace,
+              size_t threads, std::ostream& out);
+
+#endif // CACHE_SWEEP_H
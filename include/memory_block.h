@@ -13,9 +13,13 @@ struct MemoryBlock {
     MemoryBlock* next;   // Next block in the list
     MemoryBlock* prev;   // Previous block in the list
     
+    MemoryBlock* next_free;  // Next block in the same size-class free list
+    MemoryBlock* prev_free;  // Previous block in the same size-class free list
+    
     MemoryBlock(size_t addr, size_t sz, bool free = true, int id = -1)
         : address(addr), size(sz), is_free(free), block_id(id),
-          next(nullptr), prev(nullptr) {}
+          next(nullptr), prev(nullptr),
+          next_free(nullptr), prev_free(nullptr) {}
 };
 
 #endif // MEMORY_BLOCK_H
@@ -0,0 +1,111 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include "trace.h"
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+// Block sampling for stack-distance analysis (SHARDS)
+enum class SamplingMode {
+    EXACT,        // Every block
+    FIXED_RATE,   // Blocks whose hash falls under a fixed threshold
+    FIXED_SIZE    // At most N blocks, lowering the threshold as needed
+};
+
+// Mattson stack-distance analysis: one pass over a trace gives the miss
+// ratio of a fully associative LRU cache of every size, at one block size.
+// The stack distance of an access is the number of distinct blocks used
+// since the previous access to the same block (1 = same block again); a
+// cache of C blocks hits exactly the accesses at distance <= C.
+// Distances are counted with a Fenwick tree over last-use timestamps,
+// where only the most recent access of each block is marked, so each
+// access costs O(log n). When the timestamps run out the live ones are
+// renumbered 1..n, so the tree is sized by the tracked blocks, not by the
+// trace length.
+//
+// With sampling, only blocks whose spatial hash is below a threshold T
+// (out of 2^24) are tracked, at rate R = T / 2^24, and their distances are
+// scaled by 1/R. Fixed-size sampling starts at R = 1 and lowers T each time
+// more than N blocks are tracked, dropping the blocks with the highest
+// hash and rescaling the counts gathered so far, so memory stays bounded.
+// Traces can be fed in chunks (begin, feed..., finish), so they never
+// have to be held in memory.
+class StackDistanceAnalyzer {
+private:
+    static const uint32_t HASH_RANGE = 1 << 24;  // Sampling modulus
+    
+    size_t block_size;
+    size_t offset_bits;                 // log2(block_size)
+    SamplingMode mode;
+    double sampling_rate;               // FIXED_RATE
+    size_t max_blocks;                  // FIXED_SIZE
+    
+    // Counts are weights so sampled counts can be rescaled; in exact mode
+    // they stay whole numbers. Sparse, since scaled distances are spread
+    // over the whole trace's block count.
+    std::map<size_t, double> histogram; // Distance -> reuses at that distance
+    double cold_misses;                 // First use of a block
+    double total;                       // Accesses counted (sampled weight)
+    size_t accesses;                    // Accesses in the trace
+    size_t sampled_accesses;
+    double final_rate;                  // Sampling rate at the end of the pass
+    
+    // State of the pass in progress
+    uint32_t threshold;                 // Hashes below this are sampled
+    double rate;                        // threshold / HASH_RANGE
+    size_t now;                         // Last timestamp handed out
+    std::unordered_map<size_t, size_t> last_use;  // Block -> timestamp
+    std::multimap<uint32_t, size_t> by_hash;      // FIXED_SIZE: hash -> block
+    std::vector<uint32_t> fenwick;      // Marks on last-use timestamps (1-based)
+    
+    void mark(size_t timestamp, int delta);
+    size_t marksUpTo(size_t timestamp) const;
+    
+    // Renumber the live last uses 1..n in order and rebuild the tree,
+    // growing it if the live blocks fill more than half of it
+    void compact();
+    
+    // Spatial hash of a block, in [0, HASH_RANGE)
+    static uint32_t hashBlock(size_t block);
+
+public:
+    // Block size must be a power of two
+    explicit StackDistanceAnalyzer(size_t blockSize);
+    
+    // Sample a fraction 'rate' (0 < rate <= 1) of the blocks, or at most
+    // 'blocks' blocks; the default is exact analysis
+    void setFixedRate(double rate);
+    void setFixedSize(size_t blocks);
+    
+    // Analyze a trace in chunks: begin discards any earlier results, feed
+    // takes the next chunk, finish completes the curve
+    void begin();
+    void feed(const TraceRecord* records, size_t count);
+    void finish();
+    
+    // Analyze a trace held in memory (begin, feed, finish)
+    void analyze(const TraceRecord* records, size_t count);
+    
+    // Miss ratio (0-1) of a fully associative LRU cache of 'blocks' lines
+    double missRatio(size_t blocks) const;
+    
+    size_t getAccesses() const { return accesses; }
+    size_t getSampledAccesses() const { return sampled_accesses; }
+    double getFinalRate() const { return final_rate; }
+    
+    // Distinct blocks in the trace (estimated when sampling)
+    size_t getDistinctBlocks() const;
+    
+    // Print the miss ratio for cache sizes of 1, 2, 4, ... blocks, up to
+    // the size that holds every distinct block
+    void printCurve() const;
+};
+
+// Print a sampled curve next to the exact one for the same sizes, with
+// the absolute error of each row and the mean absolute error
+void printSamplingAccuracy(const StackDistanceAnalyzer& exact,
+                           const StackDistanceAnalyzer& sampled);
+
+#endif // STACK_DISTANCE_H
@@ -0,0 +1,16 @@
+#ifndef TAG_MATCH_H
+#define TAG_MATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Compare a probe tag against up to 64 tags at once.
+// Returns a mask with bit i set when tags[i] == probe (i < count).
+// The kernel (AVX2, SSE4.1 or scalar) is picked once at runtime from
+// the features of the host CPU.
+uint64_t matchTags(const size_t* tags, size_t count, size_t probe);
+
+// Name of the kernel in use ("avx2", "sse4.1" or "scalar")
+const char* tagMatchKernel();
+
+#endif // TAG_MATCH_H
@@ -0,0 +1,69 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+// One memory reference of a cache trace
+struct TraceRecord {
+    size_t address;
+    bool is_write;
+};
+
+// Load a text trace with one reference per line: "read <address>",
+// "write <address>" or "access <address>" (read), optionally prefixed
+// with "cache" so workload scripts replay as traces. Other lines are
+// skipped. Returns false (after printing an error) if the file cannot
+// be opened.
+bool loadTextTrace(const std::string& path, std::vector<TraceRecord>& records);
+
+// Reads a text trace (same format as loadTextTrace) a chunk at a time,
+// for traces too large to hold in memory
+class TextTraceReader {
+private:
+    std::ifstream file;
+
+public:
+    // Returns false (after printing an error) if the file cannot be opened
+    bool open(const std::string& path);
+    
+    // Fill up to 'max' records; returns how many, 0 at the end of the file
+    size_t read(TraceRecord* records, size_t max);
+};
+
+// Binary traces are flat arrays of 8-byte little-endian records: bit 63
+// is set for a write, the low 63 bits hold the address.
+static const uint64_t TRACE_WRITE_FLAG = (uint64_t)1 << 63;
+
+inline TraceRecord decodeTraceRecord(uint64_t raw) {
+    TraceRecord record;
+    record.address = (size_t)(raw & ~TRACE_WRITE_FLAG);
+    record.is_write = (raw & TRACE_WRITE_FLAG) != 0;
+    return record;
+}
+
+// Read-only memory mapping of a binary trace file, so large traces are
+// streamed by the page cache instead of being read into memory
+class MappedTrace {
+private:
+    const uint64_t* data;
+    size_t length;            // Mapped bytes
+    size_t count;             // Whole records
+
+public:
+    MappedTrace();
+    ~MappedTrace();
+    
+    // Map 'path'; returns false (after printing an error) if the file
+    // cannot be opened or mapped, or is not a whole number of records
+    bool open(const std::string& path);
+    void close();
+    
+    const uint64_t* records() const { return data; }
+    size_t size() const { return count; }
+};
+
+#endif // TRACE_H
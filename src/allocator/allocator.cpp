@@ -4,57 +4,139 @@
 #include <algorithm>
 
 Allocator::Allocator() 
-    : head(nullptr), total_size(0), strategy(AllocationStrategy::FIRST_FIT),
-      next_block_id(1), stats() {}
+    : head(nullptr), rover(nullptr), total_size(0), strategy(AllocationStrategy::FIRST_FIT),
+      backend(BlockBackend::LIST), next_block_id(1), requested_memory(0),
+      verbose(true), stats(), free_count(0) {
+    for (int fl = 0; fl < FL_COUNT; fl++) {
+        for (int sl = 0; sl < SL_COUNT; sl++) {
+            free_lists[fl][sl] = nullptr;
+        }
+        sl_bitmap[fl] = 0;
+    }
+    fl_bitmap = 0;
+}
 
 Allocator::~Allocator() {
-    // Free all memory blocks
-    MemoryBlock* current = head;
-    while (current != nullptr) {
-        MemoryBlock* next = current->next;
-        delete current;
-        current = next;
+    releaseBlocks();
+}
+
+void Allocator::releaseBlocks() {
+    // Return all memory blocks to the pool in one go
+    pool.releaseAll();
+    head = nullptr;
+    rover = nullptr;
+    
+    for (int fl = 0; fl < FL_COUNT; fl++) {
+        for (int sl = 0; sl < SL_COUNT; sl++) {
+            free_lists[fl][sl] = nullptr;
+        }
+        sl_bitmap[fl] = 0;
     }
+    fl_bitmap = 0;
+    free_count = 0;
+    free_by_size.clear();
+    free_by_class.clear();
+    block_table.clear();
+    table.clear();
+    buddy.clear();
 }
 
-bool Allocator::initMemory(size_t size) {
+bool Allocator::initMemory(size_t size, BlockBackend blockBackend) {
     // Clean up existing memory if any
-    MemoryBlock* current = head;
-    while (current != nullptr) {
-        MemoryBlock* next = current->next;
-        delete current;
-        current = next;
+    releaseBlocks();
+    backend = blockBackend;
+    
+    // TLSF searches the segregated lists, which only the list backend keeps
+    if (backend == BlockBackend::TABLE && strategy == AllocationStrategy::TLSF) {
+        std::cout << "Note: TLSF needs the linked list backend, using it instead of the block table\n";
+        backend = BlockBackend::LIST;
     }
     
     // Create a single free block representing all memory
-    head = new MemoryBlock(0, size, true, -1);
+    if (backend == BlockBackend::TABLE) {
+        table.reset(size);
+    } else {
+        head = pool.create(0, size, true, -1);
+        if (size > 0) {
+            insertFreeBlock(head);
+        }
+        block_table.push_back(nullptr);  // ID 0 is never handed out
+    }
+    if (strategy == AllocationStrategy::BUDDY) {
+        buddy.reset(size);
+    }
     total_size = size;
     next_block_id = 1;
+    requested_memory = 0;
     stats = AllocationStats();
     stats.total_memory = size;
     stats.free_memory = size;
     
-    std::cout << "Memory initialized: " << size << " bytes\n";
+    if (verbose) {
+        std::cout << "Memory initialized: " << size << " bytes";
+        if (backend == BlockBackend::TABLE) {
+            std::cout << " (" << getBackendName() << " backend)";
+        }
+        std::cout << "\n";
+    }
     return true;
 }
 
-void Allocator::setStrategy(AllocationStrategy strat) {
+bool Allocator::setStrategy(AllocationStrategy strat) {
+    if (strat == AllocationStrategy::TLSF && backend == BlockBackend::TABLE && isInitialized()) {
+        std::cout << "Error: TLSF needs the linked list backend; re-run init memory <size> list\n";
+        return false;
+    }
+    
+    bool to_buddy = (strat == AllocationStrategy::BUDDY);
+    bool from_buddy = (strategy == AllocationStrategy::BUDDY);
+    
+    if (to_buddy != from_buddy && isInitialized()) {
+        // The buddy allocator lays out memory on its own, so it can only
+        // take over (or hand back) a heap with nothing allocated
+        if (stats.used_memory > 0) {
+            std::cout << "Error: Cannot switch to " << (to_buddy ? "buddy" : "fit")
+                      << " allocation with live blocks; free them or re-run init memory\n";
+            return false;
+        }
+        if (to_buddy) {
+            buddy.reset(total_size);
+        } else {
+            buddy.clear();
+        }
+    }
+    
+    bool had_size_tree = usesSizeTree();
+    bool had_class_tree = usesClassTree();
     strategy = strat;
+    if (usesSizeTree() != had_size_tree || usesClassTree() != had_class_tree) {
+        rebuildSearchTrees();
+    }
+    return true;
 }
 
 void Allocator::setStrategy(const std::string& strategyName) {
+    AllocationStrategy strat;
     if (strategyName == "first_fit") {
-        strategy = AllocationStrategy::FIRST_FIT;
+        strat = AllocationStrategy::FIRST_FIT;
     } else if (strategyName == "best_fit") {
-        strategy = AllocationStrategy::BEST_FIT;
+        strat = AllocationStrategy::BEST_FIT;
     } else if (strategyName == "worst_fit") {
-        strategy = AllocationStrategy::WORST_FIT;
+        strat = AllocationStrategy::WORST_FIT;
+    } else if (strategyName == "next_fit") {
+        strat = AllocationStrategy::NEXT_FIT;
+    } else if (strategyName == "tlsf") {
+        strat = AllocationStrategy::TLSF;
+    } else if (strategyName == "buddy") {
+        strat = AllocationStrategy::BUDDY;
     } else {
         std::cout << "Unknown strategy: " << strategyName << "\n";
-        std::cout << "Available: first_fit, best_fit, worst_fit\n";
+        std::cout << "Available: first_fit, best_fit, worst_fit, next_fit, tlsf, buddy\n";
         return;
     }
-    std::cout << "Allocator set to: " << getStrategyName() << "\n";
+    if (setStrategy(strat) && verbose) {
+        std::cout << "Allocator set to: " << getStrategyName() << "\n";
+    }
 }
 
 std::string Allocator::getStrategyName() const {
@@ -62,49 +144,227 @@ std::string Allocator::getStrategyName() const {
         case AllocationStrategy::FIRST_FIT: return "First Fit";
         case AllocationStrategy::BEST_FIT: return "Best Fit";
         case AllocationStrategy::WORST_FIT: return "Worst Fit";
+        case AllocationStrategy::NEXT_FIT: return "Next Fit";
+        case AllocationStrategy::TLSF: return "TLSF";
+        case AllocationStrategy::BUDDY: return "Buddy";
         default: return "Unknown";
     }
 }
 
-MemoryBlock* Allocator::firstFit(size_t size) {
-    MemoryBlock* current = head;
-    while (current != nullptr) {
-        if (current->is_free && current->size >= size) {
-            return current;
+void Allocator::mapping(size_t size, int& fl, int& sl) {
+    if (size < (size_t)SL_COUNT) {
+        // Small sizes get one class each
+        fl = 0;
+        sl = (int)size;
+    } else {
+        int msb = 63 - __builtin_clzll(size);
+        fl = msb - SL_BITS + 1;
+        sl = (int)((size >> (msb - SL_BITS)) ^ SL_COUNT);
+    }
+}
+
+void Allocator::insertFreeBlock(MemoryBlock* block) {
+    int fl, sl;
+    mapping(block->size, fl, sl);
+    block->prev_free = nullptr;
+    block->next_free = free_lists[fl][sl];
+    if (free_lists[fl][sl] != nullptr) {
+        free_lists[fl][sl]->prev_free = block;
+    }
+    free_lists[fl][sl] = block;
+    fl_bitmap |= (uint64_t)1 << fl;
+    sl_bitmap[fl] |= (uint32_t)1 << sl;
+    free_count++;
+    
+    if (usesSizeTree()) {
+        free_by_size[std::make_pair(block->size, block->address)] = block;
+    }
+    if (usesClassTree()) {
+        free_by_class[std::make_pair(fl * SL_COUNT + sl, block->address)] = block;
+    }
+}
+
+void Allocator::removeFreeBlock(MemoryBlock* block) {
+    int fl, sl;
+    mapping(block->size, fl, sl);
+    if (block->prev_free != nullptr) {
+        block->prev_free->next_free = block->next_free;
+    } else {
+        free_lists[fl][sl] = block->next_free;
+    }
+    if (block->next_free != nullptr) {
+        block->next_free->prev_free = block->prev_free;
+    }
+    block->next_free = nullptr;
+    block->prev_free = nullptr;
+    
+    // Clear the bitmap bits once the list (and then the level) is empty
+    if (free_lists[fl][sl] == nullptr) {
+        sl_bitmap[fl] &= ~((uint32_t)1 << sl);
+        if (sl_bitmap[fl] == 0) {
+            fl_bitmap &= ~((uint64_t)1 << fl);
         }
-        current = current->next;
     }
-    return nullptr;
+    free_count--;
+    
+    if (usesSizeTree()) {
+        free_by_size.erase(std::make_pair(block->size, block->address));
+    }
+    if (usesClassTree()) {
+        free_by_class.erase(std::make_pair(fl * SL_COUNT + sl, block->address));
+    }
 }
 
-MemoryBlock* Allocator::bestFit(size_t size) {
-    MemoryBlock* best = nullptr;
-    MemoryBlock* current = head;
+bool Allocator::usesSizeTree() const {
+    return strategy == AllocationStrategy::BEST_FIT || strategy == AllocationStrategy::WORST_FIT;
+}
+
+bool Allocator::usesClassTree() const {
+    return strategy == AllocationStrategy::FIRST_FIT;
+}
+
+void Allocator::rebuildSearchTrees() {
+    free_by_size.clear();
+    free_by_class.clear();
+    for (MemoryBlock* current = head; current != nullptr; current = current->next) {
+        if (!current->is_free) {
+            continue;
+        }
+        if (usesSizeTree()) {
+            free_by_size[std::make_pair(current->size, current->address)] = current;
+        }
+        if (usesClassTree()) {
+            int fl, sl;
+            mapping(current->size, fl, sl);
+            free_by_class[std::make_pair(fl * SL_COUNT + sl, current->address)] = current;
+        }
+    }
+}
+
+size_t Allocator::largestFreeInLists() const {
+    if (fl_bitmap == 0) {
+        return 0;
+    }
+    // The largest block is in the highest non-empty class; only that
+    // class's list needs scanning
+    int fl = 63 - __builtin_clzll(fl_bitmap);
+    int sl = 31 - __builtin_clz(sl_bitmap[fl]);
+    size_t largest = 0;
+    for (MemoryBlock* current = free_lists[fl][sl]; current != nullptr; current = current->next_free) {
+        if (current->size > largest) {
+            largest = current->size;
+        }
+    }
+    return largest;
+}
+
+// First fit looks at the non-empty classes that can hold the request,
+// found through the bitmaps. Every block in a class above the request's
+// fits, so only the lowest address of each is a candidate; the request's
+// own class mixes sizes either side of it and is walked in address order
+// until a block fits or the walk passes the best candidate.
+
+MemoryBlock* Allocator::firstFit(size_t size) {
+    // Lowest-addressed free block that fits
+    MemoryBlock* first = nullptr;
+    int fl, sl;
+    mapping(size, fl, sl);
+    int own_class = fl * SL_COUNT + sl;
     
-    while (current != nullptr) {
-        if (current->is_free && current->size >= size) {
-            if (best == nullptr || current->size < best->size) {
-                best = current;
+    uint32_t sl_map = (sl + 1 < SL_COUNT) ? sl_bitmap[fl] & (~(uint32_t)0 << (sl + 1)) : 0;
+    uint64_t fl_map = (fl + 1 < FL_COUNT) ? fl_bitmap & (~(uint64_t)0 << (fl + 1)) : 0;
+    int level = fl;
+    while (true) {
+        while (sl_map != 0) {
+            int cls = __builtin_ctz(sl_map);
+            sl_map &= sl_map - 1;
+            MemoryBlock* lowest = free_by_class.lower_bound(
+                std::make_pair(level * SL_COUNT + cls, (size_t)0))->second;
+            if (first == nullptr || lowest->address < first->address) {
+                first = lowest;
             }
         }
-        current = current->next;
+        if (fl_map == 0) break;
+        level = __builtin_ctzll(fl_map);
+        fl_map &= fl_map - 1;
+        sl_map = sl_bitmap[level];
     }
-    return best;
+    
+    for (auto it = free_by_class.lower_bound(std::make_pair(own_class, (size_t)0));
+         it != free_by_class.end() && it->first.first == own_class; ++it) {
+        if (first != nullptr && it->first.second > first->address) {
+            break;
+        }
+        if (it->second->size >= size) {
+            first = it->second;
+            break;
+        }
+    }
+    return first;
+}
+
+MemoryBlock* Allocator::tlsfFit(size_t size) {
+    // Round the request up to the next class boundary so that every
+    // block in the class found below is large enough
+    size_t target = size;
+    if (size >= (size_t)SL_COUNT) {
+        int msb = 63 - __builtin_clzll(size);
+        target = size + ((size_t)1 << (msb - SL_BITS)) - 1;
+        if (target < size) {
+            return nullptr;  // Overflow: no block can be that large
+        }
+    }
+    
+    int fl, sl;
+    mapping(target, fl, sl);
+    
+    // First non-empty class at or above (fl, sl), two find-first-set ops
+    uint32_t sl_map = sl_bitmap[fl] & (~(uint32_t)0 << sl);
+    if (sl_map == 0) {
+        uint64_t fl_map = (fl + 1 < FL_COUNT) ? fl_bitmap & (~(uint64_t)0 << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return nullptr;
+        }
+        fl = __builtin_ctzll(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return free_lists[fl][sl];
+}
+
+MemoryBlock* Allocator::bestFit(size_t size) {
+    // Smallest block that fits; equal sizes are ordered by address
+    auto it = free_by_size.lower_bound(std::make_pair(size, (size_t)0));
+    if (it == free_by_size.end()) {
+        return nullptr;
+    }
+    return it->second;
 }
 
 MemoryBlock* Allocator::worstFit(size_t size) {
-    MemoryBlock* worst = nullptr;
-    MemoryBlock* current = head;
+    if (free_by_size.empty()) {
+        return nullptr;
+    }
     
-    while (current != nullptr) {
+    // Largest size is at the back; take the lowest address of that size
+    size_t largest = free_by_size.rbegin()->first.first;
+    if (largest < size) {
+        return nullptr;
+    }
+    return free_by_size.lower_bound(std::make_pair(largest, (size_t)0))->second;
+}
+
+MemoryBlock* Allocator::nextFit(size_t size) {
+    // Resume at the roving pointer and wrap around to it
+    MemoryBlock* start = (rover != nullptr) ? rover : head;
+    MemoryBlock* current = start;
+    do {
         if (current->is_free && current->size >= size) {
-            if (worst == nullptr || current->size > worst->size) {
-                worst = current;
-            }
+            return current;
         }
-        current = current->next;
-    }
-    return worst;
+        current = (current->next != nullptr) ? current->next : head;
+    } while (current != start);
+    return nullptr;
 }
 
 MemoryBlock* Allocator::findFreeBlock(size_t size) {
@@ -115,35 +375,26 @@ MemoryBlock* Allocator::findFreeBlock(size_t size) {
             return bestFit(size);
         case AllocationStrategy::WORST_FIT:
             return worstFit(size);
+        case AllocationStrategy::NEXT_FIT:
+            return nextFit(size);
+        case AllocationStrategy::TLSF:
+            return tlsfFit(size);
         default:
             return firstFit(size);
     }
 }
 
-int Allocator::allocate(size_t size) {
-    if (head == nullptr) {
-        std::cout << "Error: Memory not initialized\n";
-        return -1;
-    }
-    
-    if (size == 0) {
-        std::cout << "Error: Cannot allocate 0 bytes\n";
-        return -1;
-    }
-    
+bool Allocator::placeInList(size_t size, int id, size_t& address) {
     MemoryBlock* block = findFreeBlock(size);
-    
     if (block == nullptr) {
-        std::cout << "Allocation failed: No suitable free block for size " << size << "\n";
-        stats.allocation_failures++;
-        return -1;
+        return false;
     }
     
-    int allocated_id = next_block_id++;
+    removeFreeBlock(block);
     
     // If the block is larger than needed, split it
     if (block->size > size) {
-        MemoryBlock* new_free = new MemoryBlock(
+        MemoryBlock* new_free = pool.create(
             block->address + size,
             block->size - size,
             true,
@@ -158,140 +409,297 @@ int Allocator::allocate(size_t size) {
         }
         block->next = new_free;
         block->size = size;
+        insertFreeBlock(new_free);
     }
     
     // Mark block as allocated
     block->is_free = false;
-    block->block_id = allocated_id;
+    block->block_id = id;
+    // IDs handed out by the buddy backend leave gaps in the table
+    if ((size_t)id >= block_table.size()) {
+        block_table.resize(id + 1, nullptr);
+    }
+    block_table[id] = block;
+    rover = block->next;
+    
+    address = block->address;
+    return true;
+}
+
+bool Allocator::placeInTable(size_t size, int id, size_t& address) {
+    int slot;
+    switch (strategy) {
+        case AllocationStrategy::BEST_FIT:
+            slot = table.bestFit(size);
+            break;
+        case AllocationStrategy::WORST_FIT:
+            slot = table.worstFit(size);
+            break;
+        case AllocationStrategy::NEXT_FIT:
+            slot = table.nextFit(size);
+            break;
+        default:
+            slot = table.firstFit(size);
+            break;
+    }
+    if (slot == BlockTable::NONE) {
+        return false;
+    }
+    
+    table.allocate(slot, size, id);
+    address = table.address(slot);
+    return true;
+}
+
+int Allocator::allocate(size_t size) {
+    if (!isInitialized()) {
+        if (verbose) std::cout << "Error: Memory not initialized\n";
+        return -1;
+    }
+    
+    if (size == 0) {
+        if (verbose) std::cout << "Error: Cannot allocate 0 bytes\n";
+        return -1;
+    }
+    
+    size_t address = 0;
+    size_t granted = size;
+    bool placed;
+    if (strategy == AllocationStrategy::BUDDY) {
+        placed = buddy.allocate(size, next_block_id, address, granted);
+    } else if (backend == BlockBackend::TABLE) {
+        placed = placeInTable(size, next_block_id, address);
+    } else {
+        placed = placeInList(size, next_block_id, address);
+    }
+    
+    if (!placed) {
+        if (verbose) {
+            std::cout << "Allocation failed: No suitable free block for size " << size << "\n";
+        }
+        stats.allocation_failures++;
+        return -1;
+    }
+    
+    int allocated_id = next_block_id++;
     
     stats.num_allocations++;
-    updateStats();
+    stats.used_memory += granted;
+    stats.free_memory -= granted;
+    requested_memory += size;
     
-    std::cout << "Allocated block id=" << allocated_id 
-              << " at address=0x" << std::hex << std::setfill('0') 
-              << std::setw(4) << block->address << std::dec 
-              << " size=" << size << "\n";
+    if (verbose) {
+        std::cout << "Allocated block id=" << allocated_id 
+                  << " at address=0x" << std::hex << std::setfill('0') 
+                  << std::setw(4) << address << std::dec 
+                  << " size=" << size << "\n";
+    }
     
     return allocated_id;
 }
 
-void Allocator::coalesce(MemoryBlock* block) {
-    if (block == nullptr || !block->is_free) return;
+MemoryBlock* Allocator::coalesce(MemoryBlock* block) {
+    if (block == nullptr || !block->is_free) return block;
     
     // Merge with next block if it's free
     while (block->next != nullptr && block->next->is_free) {
         MemoryBlock* next = block->next;
+        removeFreeBlock(next);
         block->size += next->size;
         block->next = next->next;
         if (next->next != nullptr) {
             next->next->prev = block;
         }
-        delete next;
+        if (rover == next) {
+            rover = block;
+        }
+        pool.destroy(next);
     }
     
     // Merge with previous block if it's free
     while (block->prev != nullptr && block->prev->is_free) {
         MemoryBlock* prev = block->prev;
+        removeFreeBlock(prev);
         prev->size += block->size;
         prev->next = block->next;
         if (block->next != nullptr) {
             block->next->prev = prev;
         }
-        delete block;
+        if (rover == block) {
+            rover = prev;
+        }
+        pool.destroy(block);
         block = prev;
     }
+    
+    // Index the merged block under its new size
+    insertFreeBlock(block);
+    return block;
+}
+
+size_t Allocator::releaseFromList(int block_id) {
+    // Look up the block with given ID
+    if (block_id <= 0 || (size_t)block_id >= block_table.size() ||
+        block_table[block_id] == nullptr) {
+        return 0;
+    }
+    
+    MemoryBlock* block = block_table[block_id];
+    block_table[block_id] = nullptr;
+    size_t freed = block->size;
+    block->is_free = true;
+    block->block_id = -1;
+    
+    // Coalesce with adjacent free blocks
+    coalesce(block);
+    return freed;
 }
 
 bool Allocator::free(int block_id) {
-    if (head == nullptr) {
-        std::cout << "Error: Memory not initialized\n";
+    if (!isInitialized()) {
+        if (verbose) std::cout << "Error: Memory not initialized\n";
         return false;
     }
     
-    // Find the block with given ID
-    MemoryBlock* current = head;
-    while (current != nullptr) {
-        if (current->block_id == block_id && !current->is_free) {
-            current->is_free = true;
-            current->block_id = -1;
-            
-            stats.num_deallocations++;
-            
-            // Coalesce with adjacent free blocks
-            coalesce(current);
-            
-            updateStats();
-            std::cout << "Block " << block_id << " freed and merged\n";
-            return true;
-        }
-        current = current->next;
+    size_t requested = 0;
+    size_t freed;
+    if (strategy == AllocationStrategy::BUDDY) {
+        freed = buddy.release(block_id, requested);
+    } else {
+        freed = (backend == BlockBackend::TABLE)
+            ? table.release(block_id)
+            : releaseFromList(block_id);
+        requested = freed;
     }
     
-    std::cout << "Error: Block " << block_id << " not found\n";
-    return false;
+    if (freed == 0) {
+        if (verbose) std::cout << "Error: Block " << block_id << " not found\n";
+        return false;
+    }
+    
+    stats.num_deallocations++;
+    stats.used_memory -= freed;
+    stats.free_memory += freed;
+    requested_memory -= requested;
+    
+    if (verbose) std::cout << "Block " << block_id << " freed and merged\n";
+    return true;
 }
 
-void Allocator::updateStats() {
-    stats.used_memory = 0;
-    stats.free_memory = 0;
-    
-    size_t largest_free = 0;
-    size_t total_free = 0;
-    int free_block_count = 0;
+void Allocator::computeDerivedStats(AllocationStats& out) const {
+    // Byte totals are kept up to date by allocate/free; the free block
+    // count and largest free block come from the segregated lists (list
+    // backend) or a scan of the size array (table backend)
+    size_t total_free = stats.free_memory;
+    size_t free_block_count;
+    size_t largest_free;
     
-    MemoryBlock* current = head;
-    while (current != nullptr) {
-        if (current->is_free) {
-            stats.free_memory += current->size;
-            total_free += current->size;
+    if (strategy == AllocationStrategy::BUDDY) {
+        free_block_count = buddy.freeBlockCount();
+        largest_free = buddy.largestFree();
+        // Bytes past the last buddy block can never be handed out
+        if (total_size > buddy.managedSize()) {
             free_block_count++;
-            if (current->size > largest_free) {
-                largest_free = current->size;
-            }
-        } else {
-            stats.used_memory += current->size;
         }
-        current = current->next;
+    } else if (backend == BlockBackend::TABLE) {
+        free_block_count = table.freeBlockCount();
+        largest_free = free_block_count > 1 ? table.largestFree() : total_free;
+    } else {
+        free_block_count = free_count;
+        largest_free = largestFreeInLists();
+    }
+    
+    // Most block records held at once by whichever engine owns the blocks
+    if (strategy == AllocationStrategy::BUDDY) {
+        out.node_pool_high_water = buddy.highWater();
+    } else {
+        out.node_pool_high_water = (backend == BlockBackend::TABLE) ? table.slotCount() : pool.highWater();
     }
     
     // External fragmentation: 1 - (largest_free / total_free)
     if (total_free > 0 && free_block_count > 1) {
-        stats.external_fragmentation = (1.0 - (double)largest_free / total_free) * 100.0;
+        out.external_fragmentation = (1.0 - (double)largest_free / total_free) * 100.0;
     } else {
-        stats.external_fragmentation = 0.0;
+        out.external_fragmentation = 0.0;
+    }
+    
+    // Internal fragmentation: bytes handed out beyond what was requested
+    if (stats.used_memory > 0) {
+        out.internal_fragmentation =
+            (double)(stats.used_memory - requested_memory) / stats.used_memory * 100.0;
+    } else {
+        out.internal_fragmentation = 0.0;
     }
 }
 
 AllocationStats Allocator::getStats() const {
-    return stats;
+    AllocationStats result = stats;
+    if (isInitialized()) {
+        computeDerivedStats(result);
+    }
+    return result;
+}
+
+// Marker ID for memory no block can cover (buddy tail)
+static const int UNUSABLE_BLOCK = -2;
+
+// Print one line of the memory dump
+static void printBlock(size_t address, size_t size, bool is_free, int block_id) {
+    std::cout << "[0x" << std::hex << std::setfill('0') << std::setw(4) 
+              << address << " - 0x" 
+              << std::setw(4) << (address + size - 1) 
+              << std::dec << "] ";
+    
+    if (block_id == UNUSABLE_BLOCK) {
+        std::cout << "UNUSABLE";
+    } else if (is_free) {
+        std::cout << "FREE";
+    } else {
+        std::cout << "USED (id=" << block_id << ")";
+    }
+    std::cout << " [" << size << " bytes]\n";
 }
 
 void Allocator::dumpMemory() const {
-    if (head == nullptr) {
+    if (!isInitialized()) {
         std::cout << "Memory not initialized\n";
         return;
     }
     
     std::cout << "\n=== Memory Dump ===\n";
-    MemoryBlock* current = head;
-    while (current != nullptr) {
-        std::cout << "[0x" << std::hex << std::setfill('0') << std::setw(4) 
-                  << current->address << " - 0x" 
-                  << std::setw(4) << (current->address + current->size - 1) 
-                  << std::dec << "] ";
-        
-        if (current->is_free) {
-            std::cout << "FREE";
-        } else {
-            std::cout << "USED (id=" << current->block_id << ")";
+    if (strategy == AllocationStrategy::BUDDY) {
+        size_t address = 0;
+        while (address < buddy.managedSize()) {
+            size_t size = buddy.blockSize(address);
+            printBlock(address, size, buddy.isFree(address), buddy.blockId(address));
+            address += size;
+        }
+        if (address < total_size) {
+            printBlock(address, total_size - address, false, UNUSABLE_BLOCK);
+        }
+    } else if (backend == BlockBackend::TABLE) {
+        for (int slot = table.head(); slot != BlockTable::NONE; slot = table.next(slot)) {
+            printBlock(table.address(slot), table.size(slot), table.isFree(slot), table.id(slot));
+        }
+    } else {
+        for (MemoryBlock* current = head; current != nullptr; current = current->next) {
+            printBlock(current->address, current->size, current->is_free, current->block_id);
         }
-        std::cout << " [" << current->size << " bytes]\n";
-        
-        current = current->next;
     }
     std::cout << "==================\n\n";
 }
 
 bool Allocator::isInitialized() const {
+    if (backend == BlockBackend::TABLE) {
+        return table.isInitialized();
+    }
     return head != nullptr;
 }
+
+void Allocator::setVerbose(bool on) {
+    verbose = on;
+}
+
+std::string Allocator::getBackendName() const {
+    return backend == BlockBackend::TABLE ? "Block Table" : "Linked List";
+}
@@ -0,0 +1,55 @@
+#include "block_pool.h"
+#include <new>
+
+BlockPool::BlockPool()
+    : free_nodes(nullptr), chunk_index(0), chunk_used(0),
+      in_use(0), high_water(0) {}
+
+BlockPool::~BlockPool() {
+    // MemoryBlock is trivially destructible, so chunks can be dropped as-is
+    for (auto chunk : chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+MemoryBlock* BlockPool::create(size_t addr, size_t sz, bool free, int id) {
+    void* storage;
+    
+    if (free_nodes != nullptr) {
+        // Reuse a recycled node
+        storage = free_nodes;
+        free_nodes = free_nodes->next;
+    } else {
+        // Carve a fresh node, moving to (or allocating) the next chunk if needed
+        if (chunk_index < chunks.size() && chunk_used == CHUNK_NODES) {
+            chunk_index++;
+            chunk_used = 0;
+        }
+        if (chunk_index == chunks.size()) {
+            chunks.push_back(static_cast<MemoryBlock*>(
+                ::operator new(CHUNK_NODES * sizeof(MemoryBlock))));
+        }
+        storage = chunks[chunk_index] + chunk_used;
+        chunk_used++;
+    }
+    
+    in_use++;
+    if (in_use > high_water) {
+        high_water = in_use;
+    }
+    return new (storage) MemoryBlock(addr, sz, free, id);
+}
+
+void BlockPool::destroy(MemoryBlock* block) {
+    block->next = free_nodes;
+    free_nodes = block;
+    in_use--;
+}
+
+void BlockPool::releaseAll() {
+    free_nodes = nullptr;
+    chunk_index = 0;
+    chunk_used = 0;
+    in_use = 0;
+    high_water = 0;
+}
@@ -0,0 +1,194 @@
+#include "block_table.h"
+
+const int BlockTable::NONE;
+
+BlockTable::BlockTable() : head_slot(NONE), rover_slot(NONE), free_count(0) {}
+
+void BlockTable::clear() {
+    addresses.clear();
+    sizes.clear();
+    free_flags.clear();
+    ids.clear();
+    next_slots.clear();
+    prev_slots.clear();
+    unused_slots.clear();
+    id_slots.clear();
+    head_slot = NONE;
+    rover_slot = NONE;
+    free_count = 0;
+}
+
+void BlockTable::reset(size_t size) {
+    clear();
+    head_slot = newSlot(0, size);
+    free_count = 1;
+    id_slots.push_back(NONE);  // ID 0 is never handed out
+}
+
+int BlockTable::newSlot(size_t addr, size_t sz) {
+    int slot;
+    if (!unused_slots.empty()) {
+        slot = unused_slots.back();
+        unused_slots.pop_back();
+        addresses[slot] = addr;
+        sizes[slot] = sz;
+        free_flags[slot] = 1;
+        ids[slot] = -1;
+        next_slots[slot] = NONE;
+        prev_slots[slot] = NONE;
+    } else {
+        slot = (int)sizes.size();
+        addresses.push_back(addr);
+        sizes.push_back(sz);
+        free_flags.push_back(1);
+        ids.push_back(-1);
+        next_slots.push_back(NONE);
+        prev_slots.push_back(NONE);
+    }
+    return slot;
+}
+
+void BlockTable::releaseSlot(int slot) {
+    int prev = prev_slots[slot];
+    int next = next_slots[slot];
+    if (prev != NONE) {
+        next_slots[prev] = next;
+    } else {
+        head_slot = next;
+    }
+    if (next != NONE) {
+        prev_slots[next] = prev;
+    }
+    
+    // Slots are only released when merged into their previous block,
+    // which takes over as the roving cursor
+    if (rover_slot == slot) {
+        rover_slot = prev;
+    }
+    
+    // A released slot is never free, so fit scans skip it
+    free_flags[slot] = 0;
+    sizes[slot] = 0;
+    unused_slots.push_back(slot);
+}
+
+// Fit searches scan every slot in storage order, which is not address
+// order, so ties are broken on address to match a walk of the block list.
+
+int BlockTable::firstFit(size_t size) const {
+    int first = NONE;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (free_flags[i] && sizes[i] >= size) {
+            if (first == NONE || addresses[i] < addresses[first]) {
+                first = (int)i;
+            }
+        }
+    }
+    return first;
+}
+
+int BlockTable::bestFit(size_t size) const {
+    int best = NONE;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (free_flags[i] && sizes[i] >= size) {
+            if (best == NONE || sizes[i] < sizes[best] ||
+                (sizes[i] == sizes[best] && addresses[i] < addresses[best])) {
+                best = (int)i;
+            }
+        }
+    }
+    return best;
+}
+
+int BlockTable::worstFit(size_t size) const {
+    int worst = NONE;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (free_flags[i] && sizes[i] >= size) {
+            if (worst == NONE || sizes[i] > sizes[worst] ||
+                (sizes[i] == sizes[worst] && addresses[i] < addresses[worst])) {
+                worst = (int)i;
+            }
+        }
+    }
+    return worst;
+}
+
+int BlockTable::nextFit(size_t size) const {
+    // Follow the address links from the roving cursor, wrapping around
+    int start = (rover_slot != NONE) ? rover_slot : head_slot;
+    int slot = start;
+    do {
+        if (free_flags[slot] && sizes[slot] >= size) {
+            return slot;
+        }
+        slot = (next_slots[slot] != NONE) ? next_slots[slot] : head_slot;
+    } while (slot != start);
+    return NONE;
+}
+
+void BlockTable::allocate(int slot, size_t size, int id) {
+    // If the block is larger than needed, split it
+    if (sizes[slot] > size) {
+        int tail = newSlot(addresses[slot] + size, sizes[slot] - size);
+        next_slots[tail] = next_slots[slot];
+        prev_slots[tail] = slot;
+        if (next_slots[slot] != NONE) {
+            prev_slots[next_slots[slot]] = tail;
+        }
+        next_slots[slot] = tail;
+        sizes[slot] = size;
+        free_count++;
+    }
+    
+    free_flags[slot] = 0;
+    ids[slot] = id;
+    free_count--;
+    rover_slot = next_slots[slot];
+    
+    if ((size_t)id >= id_slots.size()) {
+        id_slots.resize(id + 1, NONE);
+    }
+    id_slots[id] = slot;
+}
+
+size_t BlockTable::release(int id) {
+    if (id <= 0 || (size_t)id >= id_slots.size() || id_slots[id] == NONE) {
+        return 0;
+    }
+    
+    int slot = id_slots[id];
+    id_slots[id] = NONE;
+    size_t freed = sizes[slot];
+    
+    free_flags[slot] = 1;
+    ids[slot] = -1;
+    free_count++;
+    
+    // Merge with next block if it's free
+    int next = next_slots[slot];
+    if (next != NONE && free_flags[next]) {
+        sizes[slot] += sizes[next];
+        releaseSlot(next);
+        free_count--;
+    }
+    
+    // Merge into previous block if it's free
+    int prev = prev_slots[slot];
+    if (prev != NONE && free_flags[prev]) {
+        sizes[prev] += sizes[slot];
+        releaseSlot(slot);
+        free_count--;
+    }
+    
+    return freed;
+}
+
+size_t BlockTable::largestFree() const {
+    size_t largest = 0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (free_flags[i] && sizes[i] > largest) {
+            largest = sizes[i];
+        }
+    }
+    return largest;
+}
@@ -0,0 +1,176 @@
+#include "buddy_allocator.h"
+
+const size_t BuddyAllocator::NONE;
+
+BuddyAllocator::BuddyAllocator() : managed_size(0), max_order(-1), free_count(0), high_water(0) {}
+
+void BuddyAllocator::clear() {
+    managed_size = 0;
+    max_order = -1;
+    free_count = 0;
+    high_water = 0;
+    std::unordered_map<size_t, Block>().swap(blocks);
+    free_heads.clear();
+    id_addresses.clear();
+}
+
+void BuddyAllocator::reset(size_t size) {
+    clear();
+    
+    // Round down to a whole number of minimum blocks
+    managed_size = (size >> MIN_ORDER) << MIN_ORDER;
+    if (managed_size == 0) {
+        return;
+    }
+    
+    max_order = MIN_ORDER;
+    while (max_order + 1 < 64 && ((size_t)1 << (max_order + 1)) <= managed_size) {
+        max_order++;
+    }
+    
+    free_heads.assign(max_order + 1, NONE);
+    id_addresses.push_back(NONE);  // ID 0 is never handed out
+    
+    // One top-level block per set bit, largest first so each block is
+    // aligned to its own size
+    size_t address = 0;
+    for (int order = max_order; order >= MIN_ORDER; order--) {
+        if (managed_size & ((size_t)1 << order)) {
+            pushFree(order, address);
+            address += (size_t)1 << order;
+        }
+    }
+}
+
+bool BuddyAllocator::isFreeAt(int order, size_t address) const {
+    auto it = blocks.find(address);
+    return it != blocks.end() && it->second.order == order && it->second.id == -1;
+}
+
+void BuddyAllocator::pushFree(int order, size_t address) {
+    Block& block = blocks[address];
+    block.order = order;
+    block.id = -1;
+    block.requested = 0;
+    
+    block.prev_free = NONE;
+    block.next_free = free_heads[order];
+    if (free_heads[order] != NONE) {
+        blocks[free_heads[order]].prev_free = address;
+    }
+    free_heads[order] = address;
+    free_count++;
+    if (blocks.size() > high_water) {
+        high_water = blocks.size();
+    }
+}
+
+void BuddyAllocator::removeFree(int order, size_t address) {
+    Block& block = blocks[address];
+    if (block.prev_free != NONE) {
+        blocks[block.prev_free].next_free = block.next_free;
+    } else {
+        free_heads[order] = block.next_free;
+    }
+    if (block.next_free != NONE) {
+        blocks[block.next_free].prev_free = block.prev_free;
+    }
+    block.next_free = NONE;
+    block.prev_free = NONE;
+    free_count--;
+}
+
+bool BuddyAllocator::allocate(size_t size, int id, size_t& address, size_t& granted) {
+    if (managed_size == 0 || size == 0 || size > ((size_t)1 << max_order)) {
+        return false;
+    }
+    
+    // Smallest order whose block holds the request
+    int order = MIN_ORDER;
+    while (((size_t)1 << order) < size) {
+        order++;
+    }
+    
+    // Smallest non-empty free list at or above that order
+    int from = order;
+    while (from <= max_order && free_heads[from] == NONE) {
+        from++;
+    }
+    if (from > max_order) {
+        return false;
+    }
+    
+    address = free_heads[from];
+    removeFree(from, address);
+    
+    // Split down, returning the upper halves to the free lists
+    while (from > order) {
+        from--;
+        pushFree(from, address + ((size_t)1 << from));
+    }
+    
+    Block& block = blocks[address];
+    block.order = order;
+    block.id = id;
+    block.requested = size;
+    
+    if ((size_t)id >= id_addresses.size()) {
+        id_addresses.resize(id + 1, NONE);
+    }
+    id_addresses[id] = address;
+    
+    granted = (size_t)1 << order;
+    return true;
+}
+
+size_t BuddyAllocator::release(int id, size_t& requestedSize) {
+    if (id <= 0 || (size_t)id >= id_addresses.size() || id_addresses[id] == NONE) {
+        return 0;
+    }
+    
+    size_t address = id_addresses[id];
+    id_addresses[id] = NONE;
+    
+    const Block& block = blocks[address];
+    int order = block.order;
+    size_t granted = (size_t)1 << order;
+    requestedSize = block.requested;
+    
+    // Merge with the buddy while it is a free block of the same order
+    while (order < max_order) {
+        size_t buddy = address ^ ((size_t)1 << order);
+        if (buddy + ((size_t)1 << order) > managed_size || !isFreeAt(order, buddy)) {
+            break;
+        }
+        removeFree(order, buddy);
+        blocks.erase(address > buddy ? address : buddy);
+        if (buddy < address) {
+            address = buddy;
+        }
+        order++;
+    }
+    
+    pushFree(order, address);
+    return granted;
+}
+
+size_t BuddyAllocator::largestFree() const {
+    for (int order = max_order; order >= MIN_ORDER; order--) {
+        if (free_heads[order] != NONE) {
+            return (size_t)1 << order;
+        }
+    }
+    return 0;
+}
+
+size_t BuddyAllocator::blockSize(size_t address) const {
+    return (size_t)1 << blocks.at(address).order;
+}
+
+bool BuddyAllocator::isFree(size_t address) const {
+    return blocks.at(address).id == -1;
+}
+
+int BuddyAllocator::blockId(size_t address) const {
+    return blocks.at(address).id;
+}
@@ -1,114 +1,530 @@
 #include "cache.h"
+#include "tag_match.h"
 #include <iostream>
 #include <iomanip>
-#include <cmath>
+#include <unordered_map>
+#include <numeric>
+#include <thread>
+
+// ============ Replacement Policy Names ============
+
+std::string policyName(ReplacementPolicy policy) {
+    switch (policy) {
+        case ReplacementPolicy::FIFO: return "FIFO";
+        case ReplacementPolicy::LRU: return "LRU";
+        case ReplacementPolicy::PLRU: return "Tree-PLRU";
+        case ReplacementPolicy::BIT_PLRU: return "Bit-PLRU";
+        case ReplacementPolicy::SRRIP: return "SRRIP";
+        case ReplacementPolicy::BRRIP: return "BRRIP";
+        case ReplacementPolicy::DRRIP: return "DRRIP";
+        case ReplacementPolicy::OPT: return "OPT";
+        default: return "Unknown";
+    }
+}
+
+bool parsePolicy(const std::string& text, ReplacementPolicy& policy) {
+    if (text == "fifo") {
+        policy = ReplacementPolicy::FIFO;
+    } else if (text == "lru") {
+        policy = ReplacementPolicy::LRU;
+    } else if (text == "plru") {
+        policy = ReplacementPolicy::PLRU;
+    } else if (text == "bitplru") {
+        policy = ReplacementPolicy::BIT_PLRU;
+    } else if (text == "srrip") {
+        policy = ReplacementPolicy::SRRIP;
+    } else if (text == "brrip") {
+        policy = ReplacementPolicy::BRRIP;
+    } else if (text == "drrip") {
+        policy = ReplacementPolicy::DRRIP;
+    } else if (text == "opt") {
+        policy = ReplacementPolicy::OPT;
+    } else {
+        return false;
+    }
+    return true;
+}
 
 // ============ CacheLevel Implementation ============
 
+const uint8_t CacheLevel::RRPV_MAX;
+const size_t CacheLevel::BRRIP_LONG_INTERVAL;
+const uint16_t CacheLevel::PSEL_MAX;
+const size_t CacheLevel::NO_POSITION;
+const size_t CacheLevel::NEVER;
+const size_t CacheLevel::NO_WRITEBACK;
+
+static bool isPowerOfTwo(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+static size_t log2Exact(size_t n) {
+    size_t bits = 0;
+    while ((n >> bits) > 1) {
+        bits++;
+    }
+    return bits;
+}
+
+static inline bool testBit(const std::vector<uint64_t>& bits, size_t i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+static inline void setBit(std::vector<uint64_t>& bits, size_t i, bool on) {
+    if (on) {
+        bits[i / 64] |= (uint64_t)1 << (i % 64);
+    } else {
+        bits[i / 64] &= ~((uint64_t)1 << (i % 64));
+    }
+}
+
+bool CacheLevel::validateGeometry(size_t cacheSize, size_t blockSize,
+                                  size_t assoc, ReplacementPolicy pol,
+                                  std::string& error) {
+    if (!isPowerOfTwo(blockSize)) {
+        error = "block size must be a power of two";
+        return false;
+    }
+    if (assoc == 0 || assoc > 65535) {
+        error = "associativity must be between 1 and 65535";
+        return false;
+    }
+    if (cacheSize == 0 || cacheSize % blockSize != 0) {
+        error = "cache size must be a non-zero multiple of the block size";
+        return false;
+    }
+    size_t lines = cacheSize / blockSize;
+    if (lines % assoc != 0) {
+        error = "number of lines must be a multiple of the associativity";
+        return false;
+    }
+    if (!isPowerOfTwo(lines / assoc)) {
+        error = "number of sets (size / block size / associativity) must be a power of two";
+        return false;
+    }
+    if ((pol == ReplacementPolicy::PLRU || pol == ReplacementPolicy::BIT_PLRU) && assoc > 64) {
+        error = "pseudo-LRU policies support at most 64 ways";
+        return false;
+    }
+    if (pol == ReplacementPolicy::PLRU && !isPowerOfTwo(assoc)) {
+        error = "Tree-PLRU needs a power-of-two associativity";
+        return false;
+    }
+    if (pol == ReplacementPolicy::DRRIP && lines / assoc < 4) {
+        error = "DRRIP needs at least 4 sets (a leader for each policy and followers)";
+        return false;
+    }
+    return true;
+}
+
 CacheLevel::CacheLevel(const std::string& levelName, size_t cacheSize, 
                        size_t blockSize, size_t assoc, ReplacementPolicy pol,
                        size_t latency)
     : name(levelName), size(cacheSize), block_size(blockSize), 
-      associativity(assoc), policy(pol), access_counter(0), access_latency(latency) {
+      associativity(assoc), plru_levels(0), brrip_fills(0), leader_stride(0),
+      psel(PSEL_MAX / 2 + 1), policy(pol), access_latency(latency) {
     
     num_lines = size / block_size;
     num_sets = num_lines / associativity;
     
-    // Initialize cache sets
-    sets.resize(num_sets);
-    fifo_queues.resize(num_sets);
+    offset_bits = log2Exact(block_size);
+    index_bits = log2Exact(num_sets);
+    index_mask = num_sets - 1;
+    
+    // Initialize the tag store, all lines invalid
+    tags.assign(num_lines, 0);
+    valid_bits.assign((num_lines + 63) / 64, 0);
+    dirty_bits.assign((num_lines + 63) / 64, 0);
+    if (policy == ReplacementPolicy::FIFO) {
+        fifo_next.assign(num_sets, 0);
+    }
+    
+    if (policy == ReplacementPolicy::LRU) {
+        if (associativity <= LRU_MATRIX_WAYS) {
+            // Rows of ways past the associativity are kept all ones so they
+            // never look like the LRU row
+            uint64_t matrix = 0;
+            for (size_t way = associativity; way < LRU_MATRIX_WAYS; way++) {
+                matrix |= (uint64_t)0xFF << (way * 8);
+            }
+            lru_matrix.assign(num_sets, matrix);
+        } else {
+            // Any starting order works: every way is touched when filled,
+            // before a victim is ever needed
+            lru_prev.resize(num_lines);
+            lru_next.resize(num_lines);
+            for (size_t set = 0; set < num_sets; set++) {
+                for (size_t way = 0; way < associativity; way++) {
+                    lru_prev[set * associativity + way] = (uint16_t)(way - 1);
+                    lru_next[set * associativity + way] = (uint16_t)(way + 1);
+                }
+            }
+            lru_head.assign(num_sets, 0);
+            lru_tail.assign(num_sets, (uint16_t)(associativity - 1));
+        }
+    }
+    
+    if (policy == ReplacementPolicy::PLRU || policy == ReplacementPolicy::BIT_PLRU) {
+        plru_bits.assign(num_sets, 0);
+        plru_levels = log2Exact(associativity);
+    }
+    
+    if (policy == ReplacementPolicy::SRRIP || policy == ReplacementPolicy::BRRIP ||
+        policy == ReplacementPolicy::DRRIP) {
+        rrpv.assign(num_lines, RRPV_MAX);
+        // One leader per policy in every 32 sets, between 1 and 32 of
+        // them: set 0 of each group leads for SRRIP, set 1 for BRRIP, the
+        // rest follow
+        size_t leaders = num_sets / 32;
+        if (leaders < 1) leaders = 1;
+        if (leaders > 32) leaders = 32;
+        leader_stride = num_sets / leaders;
+    }
+    
+    if (policy == ReplacementPolicy::OPT) {
+        next_use.assign(num_lines, NEVER);
+    }
+}
+
+void CacheLevel::beginTrace(const std::vector<TraceRecord>& trace) {
+    if (policy != ReplacementPolicy::OPT) {
+        return;
+    }
+    
+    // Walk backwards remembering where each block is used next
+    trace_next_use.assign(trace.size(), NEVER);
+    std::unordered_map<size_t, size_t> seen;
+    seen.reserve(trace.size() / 4);
+    for (size_t i = trace.size(); i-- > 0; ) {
+        size_t block = trace[i].address >> offset_bits;
+        auto it = seen.find(block);
+        if (it != seen.end()) {
+            trace_next_use[i] = it->second;
+            it->second = i;
+        } else {
+            seen.emplace(block, i);
+        }
+    }
+}
+
+void CacheLevel::endTrace() {
+    std::vector<size_t>().swap(trace_next_use);
+}
+
+void CacheLevel::touch(size_t set_index, size_t way) {
+    switch (policy) {
+        case ReplacementPolicy::LRU:
+            touchLru(set_index, way);
+            break;
+        case ReplacementPolicy::PLRU:
+        case ReplacementPolicy::BIT_PLRU:
+            touchPlru(set_index, way);
+            break;
+        case ReplacementPolicy::SRRIP:
+        case ReplacementPolicy::BRRIP:
+        case ReplacementPolicy::DRRIP:
+            rrpv[set_index * associativity + way] = 0;
+            break;
+        default:
+            break;  // FIFO ignores hits
+    }
+}
+
+void CacheLevel::fill(size_t set_index, size_t way) {
+    if (policy == ReplacementPolicy::SRRIP || policy == ReplacementPolicy::BRRIP ||
+        policy == ReplacementPolicy::DRRIP) {
+        fillRrip(set_index, way);
+    } else {
+        touch(set_index, way);
+    }
+}
+
+void CacheLevel::touchLru(size_t set_index, size_t way) {
+    if (associativity <= LRU_MATRIX_WAYS) {
+        uint64_t& matrix = lru_matrix[set_index];
+        uint64_t row = ((uint64_t)1 << associativity) - 1;     // Columns in use
+        matrix |= row << (way * 8);                             // Set row
+        matrix &= ~((uint64_t)0x0101010101010101 << way);      // Clear column
+        return;
+    }
+    
+    uint16_t head = lru_head[set_index];
+    if (way == head) {
+        return;
+    }
+    
+    // Unlink the way, then push it at the MRU end
+    size_t base = set_index * associativity;
+    uint16_t prev = lru_prev[base + way];
+    uint16_t next = lru_next[base + way];
+    lru_next[base + prev] = next;
+    if (way == lru_tail[set_index]) {
+        lru_tail[set_index] = prev;
+    } else {
+        lru_prev[base + next] = prev;
+    }
+    lru_next[base + way] = head;
+    lru_prev[base + head] = (uint16_t)way;
+    lru_head[set_index] = (uint16_t)way;
+}
+
+size_t CacheLevel::lruVictim(size_t set_index) const {
+    if (associativity <= LRU_MATRIX_WAYS) {
+        // Lowest all-zero byte of the matrix
+        uint64_t matrix = lru_matrix[set_index];
+        uint64_t zero_bytes = (matrix - 0x0101010101010101) & ~matrix & 0x8080808080808080;
+        return __builtin_ctzll(zero_bytes) / 8;
+    }
+    return lru_tail[set_index];
+}
+
+void CacheLevel::touchPlru(size_t set_index, size_t way) {
+    uint64_t& bits = plru_bits[set_index];
+    
+    if (policy == ReplacementPolicy::BIT_PLRU) {
+        bits |= (uint64_t)1 << way;
+        uint64_t all = (associativity == 64) ? ~(uint64_t)0 : ((uint64_t)1 << associativity) - 1;
+        if (bits == all) {
+            bits = (uint64_t)1 << way;
+        }
+        return;
+    }
+    
+    // Tree: walk root to leaf along the way's index bits, pointing each
+    // node at the other half
+    size_t node = 0;
+    for (size_t level = 0; level < plru_levels; level++) {
+        size_t dir = (way >> (plru_levels - 1 - level)) & 1;
+        if (dir) {
+            bits &= ~((uint64_t)1 << node);
+        } else {
+            bits |= (uint64_t)1 << node;
+        }
+        node = 2 * node + 1 + dir;
+    }
+}
+
+size_t CacheLevel::plruVictim(size_t set_index) const {
+    uint64_t bits = plru_bits[set_index];
+    
+    if (policy == ReplacementPolicy::BIT_PLRU) {
+        // A direct-mapped set keeps its only bit set
+        size_t way = __builtin_ctzll(~bits);
+        return way < associativity ? way : 0;
+    }
+    
+    // Tree: follow the node bits from the root
+    size_t node = 0;
+    size_t way = 0;
+    for (size_t level = 0; level < plru_levels; level++) {
+        size_t dir = (bits >> node) & 1;
+        way = (way << 1) | dir;
+        node = 2 * node + 1 + dir;
+    }
+    return way;
+}
+
+void CacheLevel::fillRrip(size_t set_index, size_t way) {
+    ReplacementPolicy insertion = policy;
+    
+    if (policy == ReplacementPolicy::DRRIP) {
+        // Every fill is a miss: a miss in a leader set votes against its policy
+        size_t group_slot = set_index & (leader_stride - 1);
+        if (group_slot == 0) {
+            insertion = ReplacementPolicy::SRRIP;
+            if (psel < PSEL_MAX) psel++;
+        } else if (group_slot == 1) {
+            insertion = ReplacementPolicy::BRRIP;
+            if (psel > 0) psel--;
+        } else {
+            insertion = (psel > PSEL_MAX / 2) ? ReplacementPolicy::BRRIP : ReplacementPolicy::SRRIP;
+        }
+    }
+    
+    uint8_t value = RRPV_MAX - 1;
+    if (insertion == ReplacementPolicy::BRRIP) {
+        // Deterministic throttle rather than a random draw, so runs repeat
+        if (++brrip_fills < BRRIP_LONG_INTERVAL) {
+            value = RRPV_MAX;
+        } else {
+            brrip_fills = 0;
+        }
+    }
+    rrpv[set_index * associativity + way] = value;
+}
+
+size_t CacheLevel::rripVictim(size_t set_index) {
+    uint8_t* set = &rrpv[set_index * associativity];
     
-    for (size_t i = 0; i < num_sets; i++) {
-        sets[i].resize(associativity);
+    // Ageing until some way reaches RRPV_MAX is the same as adding the
+    // gap between the oldest way and RRPV_MAX to every way at once
+    size_t victim = 0;
+    for (size_t way = 1; way < associativity; way++) {
+        if (set[way] > set[victim]) {
+            victim = way;
+        }
+    }
+    uint8_t age = RRPV_MAX - set[victim];
+    if (age != 0) {
+        for (size_t way = 0; way < associativity; way++) {
+            set[way] += age;
+        }
+    }
+    return victim;
+}
+
+size_t CacheLevel::optVictim(size_t set_index) const {
+    const size_t* set = &next_use[set_index * associativity];
+    size_t victim = 0;
+    for (size_t way = 1; way < associativity; way++) {
+        if (set[way] > set[victim]) {
+            victim = way;
+        }
     }
+    return victim;
 }
 
 size_t CacheLevel::getSetIndex(size_t address) const {
-    // Remove block offset bits, then mod by number of sets
-    size_t block_bits = (size_t)std::log2(block_size);
-    return (address >> block_bits) % num_sets;
+    // Remove block offset bits, then keep the set index bits
+    return (address >> offset_bits) & index_mask;
 }
 
 size_t CacheLevel::getTag(size_t address) const {
-    size_t block_bits = (size_t)std::log2(block_size);
-    size_t set_bits = (size_t)std::log2(num_sets);
-    return address >> (block_bits + set_bits);
+    return address >> (offset_bits + index_bits);
 }
 
 size_t CacheLevel::findVictim(size_t set_index) {
-    auto& set = sets[set_index];
+    size_t base = set_index * associativity;
     
     // First, look for an invalid line
     for (size_t i = 0; i < associativity; i++) {
-        if (!set[i].valid) {
+        if (!testBit(valid_bits, base + i)) {
             return i;
         }
     }
     
     // All lines valid, use replacement policy
-    if (policy == ReplacementPolicy::FIFO) {
-        // FIFO: evict the first one that came in
-        size_t victim = fifo_queues[set_index].front();
-        fifo_queues[set_index].pop_front();
-        return victim;
-    } else {
-        // LRU: find line with smallest last_access
-        size_t victim = 0;
-        size_t min_access = set[0].last_access;
-        for (size_t i = 1; i < associativity; i++) {
-            if (set[i].last_access < min_access) {
-                min_access = set[i].last_access;
-                victim = i;
-            }
+    switch (policy) {
+        case ReplacementPolicy::FIFO: {
+            // FIFO: evict the first one that came in, then move the pointer on
+            size_t victim = fifo_next[set_index];
+            fifo_next[set_index] = (uint16_t)(victim + 1 == associativity ? 0 : victim + 1);
+            return victim;
         }
-        return victim;
+        case ReplacementPolicy::PLRU:
+        case ReplacementPolicy::BIT_PLRU:
+            return plruVictim(set_index);
+        case ReplacementPolicy::SRRIP:
+        case ReplacementPolicy::BRRIP:
+        case ReplacementPolicy::DRRIP:
+            return rripVictim(set_index);
+        case ReplacementPolicy::OPT:
+            return optVictim(set_index);
+        default:
+            // LRU: least recently used way from the recency state
+            return lruVictim(set_index);
     }
 }
 
-bool CacheLevel::access(size_t address, bool isWrite) {
-    stats.accesses++;
-    stats.total_access_time += access_latency;  // Always pay the access cost
-    access_counter++;
+bool CacheLevel::access(size_t address, bool isWrite, size_t position, size_t* writeback) {
+    return lookup(address, isWrite, position, stats, writeback);
+}
+
+bool CacheLevel::lookup(size_t address, bool isWrite, size_t position, CacheStats& counters,
+                        size_t* writeback) {
+    if (writeback != nullptr) {
+        *writeback = NO_WRITEBACK;
+    }
+
+    counters.accesses++;
+    counters.total_access_time += access_latency;  // Always pay the access cost
     
     size_t set_index = getSetIndex(address);
     size_t tag = getTag(address);
-    auto& set = sets[set_index];
+    size_t base = set_index * associativity;
     
-    // Check for hit
-    for (size_t i = 0; i < associativity; i++) {
-        if (set[i].valid && set[i].tag == tag) {
-            // Hit!
-            stats.hits++;
-            set[i].last_access = access_counter;  // Update for LRU
-            if (isWrite) {
-                set[i].dirty = true;  // Mark as modified
+    // Check for hit: compare all ways of the set in one go (64 at a time),
+    // then confirm the matching way holds a valid line
+    for (size_t first = 0; first < associativity; first += 64) {
+        size_t count = associativity - first < 64 ? associativity - first : 64;
+        uint64_t matches = matchTags(&tags[base + first], count, tag);
+        while (matches != 0) {
+            size_t line = base + first + __builtin_ctzll(matches);
+            matches &= matches - 1;
+            if (testBit(valid_bits, line)) {
+                // Hit!
+                counters.hits++;
+                touch(set_index, line - base);
+                // A hit outside the trace (a write-back) is not a use of
+                // the block, so it keeps its next use
+                if (policy == ReplacementPolicy::OPT && position != NO_POSITION) {
+                    next_use[line] = trace_next_use.empty() ? NEVER : trace_next_use[position];
+                }
+                if (isWrite) {
+                    setBit(dirty_bits, line, true);  // Mark as modified
+                }
+                return true;
             }
-            return true;
         }
     }
     
     // Miss - find victim and replace
-    stats.misses++;
+    counters.misses++;
     size_t victim = findVictim(set_index);
+    size_t line = base + victim;
     
     // Check if victim is dirty (needs write-back)
-    if (set[victim].valid && set[victim].dirty) {
-        stats.write_backs++;
+    if (testBit(valid_bits, line) && testBit(dirty_bits, line)) {
+        counters.write_backs++;
+        if (writeback != nullptr) {
+            // Rebuild the victim's block address from its tag and set
+            *writeback = ((tags[line] << index_bits) | set_index) << offset_bits;
+        }
     }
     
-    set[victim].valid = true;
-    set[victim].tag = tag;
-    set[victim].last_access = access_counter;
-    set[victim].dirty = isWrite;  // New line is dirty if this is a write
-    
-    // Update FIFO queue
-    if (policy == ReplacementPolicy::FIFO) {
-        fifo_queues[set_index].push_back(victim);
+    setBit(valid_bits, line, true);
+    tags[line] = tag;
+    fill(set_index, victim);
+    if (policy == ReplacementPolicy::OPT) {
+        next_use[line] = trace_next_use.empty() || position == NO_POSITION
+                         ? NEVER : trace_next_use[position];
     }
+    setBit(dirty_bits, line, isWrite);  // New line is dirty if this is a write
     
     return false;
 }
 
+bool CacheLevel::hasGlobalState() const {
+    return policy == ReplacementPolicy::BRRIP || policy == ReplacementPolicy::DRRIP;
+}
+
+size_t CacheLevel::shardGranularity() const {
+    // Lines are packed 64 to a word in the valid/dirty bitsets; a run of
+    // sets must fill whole words
+    return 64 / std::gcd(associativity, (size_t)64);
+}
+
+void CacheLevel::accessShard(const TraceRecord* records, size_t count,
+                             size_t first_set, size_t end_set,
+                             size_t first_position, CacheStats& counters) {
+    for (size_t i = 0; i < count; i++) {
+        size_t set_index = getSetIndex(records[i].address);
+        if (set_index < first_set || set_index >= end_set) {
+            continue;
+        }
+        size_t position = (first_position == NO_POSITION) ? NO_POSITION : first_position + i;
+        lookup(records[i].address, records[i].is_write, position, counters);
+    }
+}
+
+void CacheLevel::addStats(const CacheStats& counters) {
+    stats.hits += counters.hits;
+    stats.misses += counters.misses;
+    stats.accesses += counters.accesses;
+    stats.write_backs += counters.write_backs;
+    stats.total_access_time += counters.total_access_time;
+}
+
 CacheStats CacheLevel::getStats() const {
     return stats;
 }
@@ -122,13 +538,22 @@ std::string CacheLevel::getInfo() const {
     info += std::to_string(size) + " bytes, ";
     info += std::to_string(block_size) + "B blocks, ";
     info += std::to_string(associativity) + "-way, ";
-    info += (policy == ReplacementPolicy::FIFO ? "FIFO" : "LRU");
+    info += policyName(policy);
     return info;
 }
 
+std::string CacheLevel::getDuelInfo() const {
+    if (policy != ReplacementPolicy::DRRIP) {
+        return "";
+    }
+    return std::string("followers use ") + (psel > PSEL_MAX / 2 ? "BRRIP" : "SRRIP") +
+           " (PSEL " + std::to_string(psel) + "/" + std::to_string(PSEL_MAX) + ")";
+}
+
 // ============ CacheSimulator Implementation ============
 
-CacheSimulator::CacheSimulator() : initialized(false), total_access_time(0), memory_latency(100) {}
+CacheSimulator::CacheSimulator()
+    : initialized(false), total_access_time(0), memory_latency(100), verbose(true) {}
 
 CacheSimulator::~CacheSimulator() {
     for (auto level : levels) {
@@ -136,42 +561,191 @@ CacheSimulator::~CacheSimulator() {
     }
 }
 
-void CacheSimulator::addLevel(const std::string& name, size_t size, 
+bool CacheSimulator::addLevel(const std::string& name, size_t size, 
                                size_t blockSize, size_t associativity,
                                ReplacementPolicy policy, size_t latency) {
+    std::string error;
+    if (!CacheLevel::validateGeometry(size, blockSize, associativity, policy, error)) {
+        if (verbose) {
+            std::cout << "Error: Invalid " << name << " configuration: " << error << "\n";
+        }
+        return false;
+    }
+    
     levels.push_back(new CacheLevel(name, size, blockSize, associativity, policy, latency));
     initialized = true;
-    std::cout << "Added cache level: " << levels.back()->getInfo() 
-              << " (" << latency << " cycle" << (latency > 1 ? "s" : "") << " latency)\n";
+    if (verbose) {
+        std::cout << "Added cache level: " << levels.back()->getInfo() 
+                  << " (" << latency << " cycle" << (latency > 1 ? "s" : "") << " latency)\n";
+    }
+    return true;
+}
+
+size_t CacheSimulator::accessLevels(size_t address, bool isWrite, size_t position,
+                                    size_t& access_time, size_t& writeback_time) {
+    access_time = 0;
+    writeback_time = 0;
+    size_t hit_level = levels.size();
+    for (size_t i = 0; i < levels.size(); i++) {
+        access_time += levels[i]->getLatency();
+        // Only L1 takes the store; lower levels are filled clean and only
+        // become dirty when a dirty line is written back into them
+        size_t victim;
+        if (levels[i]->access(address, isWrite && i == 0, position, &victim)) {
+            hit_level = i;
+            break;
+        }
+        // Miss at this level: a dirty victim is written to the next level
+        if (victim != CacheLevel::NO_WRITEBACK) {
+            writeback_time += writeBack(i + 1, victim);
+        }
+    }
+    
+    if (hit_level == levels.size()) {
+        // Miss at all levels - access main memory
+        access_time += memory_latency;
+    }
+    access_time += writeback_time;
+    total_access_time += access_time;
+    return hit_level;
+}
+
+size_t CacheSimulator::writeBack(size_t index, size_t address) {
+    if (index == levels.size()) {
+        return memory_latency;
+    }
+    
+    size_t cycles = levels[index]->getLatency();
+    size_t victim;
+    levels[index]->access(address, true, CacheLevel::NO_POSITION, &victim);
+    if (victim != CacheLevel::NO_WRITEBACK) {
+        cycles += writeBack(index + 1, victim);
+    }
+    return cycles;
 }
 
 void CacheSimulator::access(size_t address, bool isWrite) {
     // Access through cache hierarchy with verbose output
     size_t access_time = 0;
+    size_t writeback_time = 0;
+    size_t hit_level = accessLevels(address, isWrite, CacheLevel::NO_POSITION,
+                                    access_time, writeback_time);
+    if (!verbose) {
+        return;
+    }
+    
     std::string path = "";
     std::string op = isWrite ? "WRITE" : "READ";
+    for (size_t i = 0; i < hit_level; i++) {
+        path += levels[i]->getName() + " MISS → ";
+    }
+    if (hit_level < levels.size()) {
+        path += levels[hit_level]->getName() + " HIT";
+    } else {
+        path += "MEMORY";
+    }
+    std::cout << "  [" << op << "] → " << path << " (" << access_time << " cycles";
+    if (writeback_time > 0) {
+        std::cout << ", " << writeback_time << " writing back dirty lines";
+    }
+    std::cout << ")\n";
+}
+
+BatchResult CacheSimulator::accessBatch(const TraceRecord* records, size_t count,
+                                        size_t first_position) {
+    BatchResult result;
+    size_t memory_level = levels.size();
+    size_t access_time = 0;
+    size_t writeback_time = 0;
     
-    for (size_t i = 0; i < levels.size(); i++) {
-        auto level = levels[i];
-        access_time += level->getLatency();
-        
-        if (level->access(address, isWrite)) {
-            // Hit at this level
-            path += level->getName() + " HIT";
-            std::cout << "  [" << op << "] → " << path << " (" << access_time << " cycles)\n";
-            total_access_time += access_time;
-            return;
-        } else {
-            // Miss at this level, continue to next
-            path += level->getName() + " MISS → ";
+    for (size_t i = 0; i < count; i++) {
+        size_t position = (first_position == CacheLevel::NO_POSITION)
+                          ? CacheLevel::NO_POSITION : first_position + i;
+        if (accessLevels(records[i].address, records[i].is_write, position,
+                         access_time, writeback_time) == memory_level) {
+            result.memory_accesses++;
         }
+        result.total_cycles += access_time;
+    }
+    result.accesses = count;
+    return result;
+}
+
+bool CacheSimulator::accessBatchParallel(const TraceRecord* records, size_t count,
+                                         size_t threads, BatchResult& result,
+                                         size_t first_position) {
+    if (levels.size() != 1) {
+        std::cout << "Error: Parallel replay needs a single cache level\n";
+        return false;
+    }
+    CacheLevel* level = levels[0];
+    if (level->hasGlobalState()) {
+        std::cout << "Error: Parallel replay does not support " << level->getInfo()
+                  << " (replacement state shared between sets)\n";
+        return false;
     }
     
-    // Miss at all levels - access main memory
-    access_time += memory_latency;
-    path += "MEMORY";
-    std::cout << "  [" << op << "] → " << path << " (" << access_time << " cycles)\n";
-    total_access_time += access_time;
+    // Split the sets into contiguous runs of whole shard units
+    size_t unit = level->shardGranularity();
+    size_t units = (level->getNumSets() + unit - 1) / unit;
+    if (threads > units) threads = units;
+    if (threads == 0) threads = 1;
+    
+    std::vector<CacheStats> counters(threads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        size_t first_set = (t * units / threads) * unit;
+        size_t end_set = ((t + 1) * units / threads) * unit;
+        workers.emplace_back(&CacheLevel::accessShard, level, records, count,
+                             first_set, end_set, first_position, std::ref(counters[t]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    // Merge in thread order so the totals match the serial path
+    size_t misses = 0;
+    size_t write_backs = 0;
+    for (const auto& shard : counters) {
+        level->addStats(shard);
+        misses += shard.misses;
+        write_backs += shard.write_backs;
+    }
+    
+    // Dirty evictions from the only level go to memory
+    result = BatchResult();
+    result.accesses = count;
+    result.memory_accesses = misses;
+    result.total_cycles = count * level->getLatency() + (misses + write_backs) * memory_latency;
+    total_access_time += result.total_cycles;
+    return true;
+}
+
+BatchResult CacheSimulator::runTrace(const std::vector<TraceRecord>& trace) {
+    for (auto level : levels) {
+        level->beginTrace(trace);
+    }
+    
+    BatchResult result = accessBatch(trace.data(), trace.size(), 0);
+    
+    for (auto level : levels) {
+        level->endTrace();
+    }
+    return result;
+}
+
+bool CacheSimulator::runTraceParallel(const std::vector<TraceRecord>& trace, size_t threads,
+                                      BatchResult& result) {
+    for (auto level : levels) {
+        level->beginTrace(trace);
+    }
+    
+    bool ok = accessBatchParallel(trace.data(), trace.size(), threads, result, 0);
+    
+    for (auto level : levels) {
+        level->endTrace();
+    }
+    return ok;
 }
 
 void CacheSimulator::printStats() const {
@@ -197,6 +771,10 @@ void CacheSimulator::printConfig() const {
     std::cout << "\n=== Cache Configuration ===\n";
     for (const auto& level : levels) {
         std::cout << "  " << level->getInfo() << "\n";
+        std::string duel = level->getDuelInfo();
+        if (!duel.empty()) {
+            std::cout << "    " << duel << "\n";
+        }
     }
     std::cout << "===========================\n\n";
 }
@@ -205,5 +783,7 @@ void CacheSimulator::resetStats() {
     for (auto level : levels) {
         level->resetStats();
     }
-    std::cout << "Cache statistics reset\n";
+    if (verbose) {
+        std::cout << "Cache statistics reset\n";
+    }
 }
@@ -0,0 +1,146 @@
+#include "cache_sweep.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+
+// Per-configuration results, filled in by the worker threads
+struct SweepResult {
+    BatchResult batch;
+    std::vector<CacheStats> level_stats;
+};
+
+static bool parseLevel(const std::string& text, LevelConfig& level, std::string& error) {
+    std::istringstream iss(text);
+    std::string policy, extra;
+    if (!(iss >> level.size >> level.block_size >> level.associativity >> policy >> level.latency)) {
+        error = "expected '<size> <block> <assoc> <policy> <latency>'";
+        return false;
+    }
+    if (iss >> extra) {
+        error = "unexpected '" + extra + "'";
+        return false;
+    }
+    if (!parsePolicy(policy, level.policy)) {
+        error = "unknown policy '" + policy + "'";
+        return false;
+    }
+    return CacheLevel::validateGeometry(level.size, level.block_size, level.associativity,
+                                        level.policy, error);
+}
+
+bool loadSweepConfigs(const std::string& path, std::vector<SweepConfig>& configs) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Error: Cannot open sweep config file '" << path << "'\n";
+        return false;
+    }
+    
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r");
+        
+        SweepConfig config;
+        config.text = line.substr(start, end - start + 1);
+        
+        std::istringstream levels(config.text);
+        std::string level_text;
+        while (std::getline(levels, level_text, '/')) {
+            LevelConfig level;
+            std::string error;
+            if (!parseLevel(level_text, level, error)) {
+                std::cout << "Error: " << path << ":" << line_number << ": level "
+                          << config.levels.size() + 1 << ": " << error << "\n";
+                return false;
+            }
+            config.levels.push_back(level);
+        }
+        configs.push_back(config);
+    }
+    return true;
+}
+
+static void simulate(const SweepConfig& config, const std::vector<TraceRecord>& trace,
+                     SweepResult& result) {
+    CacheSimulator simulator;
+    simulator.setVerbose(false);
+    for (size_t i = 0; i < config.levels.size(); i++) {
+        const LevelConfig& level = config.levels[i];
+        simulator.addLevel("L" + std::to_string(i + 1), level.size, level.block_size,
+                           level.associativity, level.policy, level.latency);
+    }
+    
+    result.batch = simulator.runTrace(trace);
+    for (size_t i = 0; i < simulator.getLevelCount(); i++) {
+        result.level_stats.push_back(simulator.getLevel(i).getStats());
+    }
+}
+
+// Quote a CSV field (the config text may contain commas or quotes)
+static std::string csvField(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void runSweep(const std::vector<SweepConfig>& configs,
+              const std::vector<TraceRecord>& trace,
+              size_t threads, std::ostream& out) {
+    std::vector<SweepResult> results(configs.size());
+    
+    // Workers take the next configuration until none are left
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < configs.size(); i = next++) {
+            simulate(configs[i], trace, results[i]);
+        }
+    };
+    
+    if (threads > configs.size()) threads = configs.size();
+    if (threads == 0) threads = 1;
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    
+    // Header sized for the deepest hierarchy; shallower rows leave blanks
+    size_t max_levels = 0;
+    for (const auto& config : configs) {
+        if (config.levels.size() > max_levels) max_levels = config.levels.size();
+    }
+    out << "config,accesses,memory_accesses,total_cycles,avg_cycles";
+    for (size_t i = 1; i <= max_levels; i++) {
+        out << ",L" << i << "_hit_ratio,L" << i << "_access_time";
+    }
+    out << "\n";
+    
+    for (size_t c = 0; c < configs.size(); c++) {
+        const SweepResult& result = results[c];
+        out << csvField(configs[c].text) << "," << result.batch.accesses << ","
+            << result.batch.memory_accesses << "," << result.batch.total_cycles << ","
+            << std::fixed << std::setprecision(2) << result.batch.averageCycles();
+        for (size_t i = 0; i < max_levels; i++) {
+            if (i < result.level_stats.size()) {
+                out << "," << result.level_stats[i].hitRatio()
+                    << "," << result.level_stats[i].total_access_time;
+            } else {
+                out << ",,";
+            }
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,265 @@
+#include "stack_distance.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+const uint32_t StackDistanceAnalyzer::HASH_RANGE;
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(size_t blockSize)
+    : block_size(blockSize), offset_bits(0), mode(SamplingMode::EXACT),
+      sampling_rate(1.0), max_blocks(0), cold_misses(0), total(0),
+      accesses(0), sampled_accesses(0), final_rate(1.0),
+      threshold(HASH_RANGE), rate(1.0), now(0) {
+    while (((size_t)1 << offset_bits) < block_size) {
+        offset_bits++;
+    }
+}
+
+void StackDistanceAnalyzer::setFixedRate(double rate) {
+    mode = SamplingMode::FIXED_RATE;
+    sampling_rate = rate;
+}
+
+void StackDistanceAnalyzer::setFixedSize(size_t blocks) {
+    mode = SamplingMode::FIXED_SIZE;
+    max_blocks = blocks;
+}
+
+uint32_t StackDistanceAnalyzer::hashBlock(size_t block) {
+    // splitmix64 finalizer
+    uint64_t x = block;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (uint32_t)(x & (HASH_RANGE - 1));
+}
+
+void StackDistanceAnalyzer::mark(size_t timestamp, int delta) {
+    for (size_t i = timestamp; i < fenwick.size(); i += i & (~i + 1)) {
+        fenwick[i] += delta;
+    }
+}
+
+size_t StackDistanceAnalyzer::marksUpTo(size_t timestamp) const {
+    size_t sum = 0;
+    for (size_t i = timestamp; i > 0; i -= i & (~i + 1)) {
+        sum += fenwick[i];
+    }
+    return sum;
+}
+
+void StackDistanceAnalyzer::compact() {
+    std::vector<std::pair<size_t, size_t*>> order;
+    order.reserve(last_use.size());
+    for (auto& entry : last_use) {
+        order.emplace_back(entry.second, &entry.second);
+    }
+    std::sort(order.begin(), order.end());
+    
+    size_t capacity = fenwick.size() - 1;
+    if (order.size() * 2 > capacity) {
+        capacity *= 2;
+    }
+    fenwick.assign(capacity + 1, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        *order[i].second = i + 1;
+        mark(i + 1, 1);
+    }
+    now = order.size();
+}
+
+void StackDistanceAnalyzer::begin() {
+    histogram.clear();
+    cold_misses = 0;
+    total = 0;
+    accesses = 0;
+    sampled_accesses = 0;
+    
+    threshold = HASH_RANGE;
+    if (mode == SamplingMode::FIXED_RATE) {
+        threshold = (uint32_t)std::llround(sampling_rate * HASH_RANGE);
+        if (threshold == 0) threshold = 1;
+    }
+    rate = (double)threshold / HASH_RANGE;
+    
+    // Fixed-size sampling never tracks more than max_blocks + 1 blocks, so
+    // its tree never grows; the others grow with the tracked blocks
+    size_t capacity = (mode == SamplingMode::FIXED_SIZE) ? 2 * max_blocks + 64 : 1024;
+    fenwick.assign(capacity + 1, 0);
+    last_use.clear();
+    by_hash.clear();
+    now = 0;
+}
+
+void StackDistanceAnalyzer::feed(const TraceRecord* records, size_t count) {
+    accesses += count;
+    for (size_t i = 0; i < count; i++) {
+        size_t block = records[i].address >> offset_bits;
+        uint32_t hash = 0;
+        if (mode != SamplingMode::EXACT) {
+            hash = hashBlock(block);
+            if (hash >= threshold) {
+                continue;
+            }
+        }
+        
+        if (now + 1 >= fenwick.size()) {
+            compact();
+        }
+        now++;
+        sampled_accesses++;
+        total += 1;
+        
+        auto it = last_use.find(block);
+        if (it == last_use.end()) {
+            cold_misses += 1;
+            last_use.emplace(block, now);
+            if (mode == SamplingMode::FIXED_SIZE) {
+                by_hash.emplace(hash, block);
+            }
+        } else {
+            // Blocks whose last use falls between the two accesses, plus itself
+            size_t previous = it->second;
+            size_t distance = marksUpTo(now - 1) - marksUpTo(previous) + 1;
+            // Only the other blocks in between are sampled at the rate
+            size_t scaled = (size_t)std::llround((distance - 1) / rate) + 1;
+            histogram[scaled] += 1;
+            
+            mark(previous, -1);
+            it->second = now;
+        }
+        mark(now, 1);
+        
+        if (mode == SamplingMode::FIXED_SIZE && last_use.size() > max_blocks) {
+            // Drop every block at the highest hash and sample below it from now on
+            uint32_t lowered = by_hash.rbegin()->first;
+            auto first = by_hash.lower_bound(lowered);
+            for (auto drop = first; drop != by_hash.end(); ++drop) {
+                auto entry = last_use.find(drop->second);
+                mark(entry->second, -1);
+                last_use.erase(entry);
+            }
+            by_hash.erase(first, by_hash.end());
+            
+            // Rescale what was counted at the old rate to the new one
+            double scale = (double)lowered / threshold;
+            for (auto& bucket : histogram) {
+                bucket.second *= scale;
+            }
+            cold_misses *= scale;
+            total *= scale;
+            threshold = lowered;
+            rate = (double)threshold / HASH_RANGE;
+        }
+    }
+}
+
+void StackDistanceAnalyzer::finish() {
+    final_rate = rate;
+    
+    // SHARDS-adj: put the gap between the expected and the actual number of
+    // sampled accesses into the smallest-distance bucket. Counts from
+    // earlier, higher rates were rescaled, so the expectation is at the
+    // final rate.
+    if (mode != SamplingMode::EXACT && accesses > 0) {
+        double expected = accesses * rate;
+        histogram[1] += expected - total;
+        total = expected;
+    }
+    
+    std::vector<uint32_t>().swap(fenwick);
+    std::unordered_map<size_t, size_t>().swap(last_use);
+    by_hash.clear();
+}
+
+void StackDistanceAnalyzer::analyze(const TraceRecord* records, size_t count) {
+    begin();
+    feed(records, count);
+    finish();
+}
+
+double StackDistanceAnalyzer::missRatio(size_t blocks) const {
+    if (total <= 0) {
+        return 0.0;
+    }
+    double misses = cold_misses;
+    for (auto it = histogram.upper_bound(blocks); it != histogram.end(); ++it) {
+        misses += it->second;
+    }
+    double ratio = misses / total;
+    return ratio < 0 ? 0.0 : (ratio > 1 ? 1.0 : ratio);
+}
+
+size_t StackDistanceAnalyzer::getDistinctBlocks() const {
+    return (size_t)std::llround(cold_misses / final_rate);
+}
+
+void StackDistanceAnalyzer::printCurve() const {
+    std::cout << "\n=== Miss Ratio Curve (fully associative LRU, "
+              << block_size << "B blocks) ===\n";
+    std::cout << "Accesses:        " << accesses << "\n";
+    if (mode == SamplingMode::EXACT) {
+        std::cout << "Distinct blocks: " << getDistinctBlocks() << "\n";
+    } else {
+        std::cout << "Sampled:         " << sampled_accesses << " accesses, final rate "
+                  << std::fixed << std::setprecision(4) << final_rate << "\n";
+        std::cout << "Distinct blocks: ~" << getDistinctBlocks() << " (estimated)\n";
+    }
+    std::cout << "  Cache size (bytes)    Blocks   Miss ratio\n";
+    
+    size_t distinct = getDistinctBlocks();
+    for (size_t blocks = 1; ; blocks *= 2) {
+        std::cout << "  " << std::setw(18) << blocks * block_size
+                  << "  " << std::setw(8) << blocks
+                  << "  " << std::setw(10) << std::fixed << std::setprecision(2)
+                  << missRatio(blocks) * 100.0 << "%\n";
+        if (blocks >= distinct) {
+            break;
+        }
+    }
+    std::cout << "==========================================\n\n";
+}
+
+void printSamplingAccuracy(const StackDistanceAnalyzer& exact,
+                           const StackDistanceAnalyzer& sampled) {
+    std::cout << "\n=== Sampling Accuracy ===\n";
+    std::cout << "Sampled " << sampled.getSampledAccesses() << " of " << exact.getAccesses()
+              << " accesses (final rate " << std::fixed << std::setprecision(4)
+              << sampled.getFinalRate() << ")\n";
+    std::cout << "Distinct blocks: " << exact.getDistinctBlocks() << " exact, ~"
+              << sampled.getDistinctBlocks() << " estimated\n";
+    std::cout << "    Blocks       Exact     Sampled   Abs error\n";
+    
+    // A sampled distance stands for 1/rate blocks, so smaller caches are
+    // below the resolution of the sample and left out of the error summary
+    double resolution = 1.0 / sampled.getFinalRate();
+    double error_sum = 0;
+    size_t rows = 0;
+    double max_error = 0;
+    for (size_t blocks = 1; ; blocks *= 2) {
+        double e = exact.missRatio(blocks) * 100.0;
+        double s = sampled.missRatio(blocks) * 100.0;
+        double error = std::fabs(e - s);
+        bool resolved = blocks >= resolution;
+        if (resolved) {
+            error_sum += error;
+            rows++;
+            if (error > max_error) max_error = error;
+        }
+        std::cout << "  " << std::setw(8) << blocks
+                  << "  " << std::setw(9) << std::setprecision(2) << e << "%"
+                  << "  " << std::setw(9) << s << "%"
+                  << "  " << std::setw(9) << error << "%" << (resolved ? "" : " *") << "\n";
+        if (blocks >= exact.getDistinctBlocks()) {
+            break;
+        }
+    }
+    std::cout << "(* below the sampling resolution of " << std::setprecision(0) << resolution
+              << " blocks, not in the summary)\n";
+    std::cout << "Mean absolute error: " << std::setprecision(2) << (rows > 0 ? error_sum / rows : 0.0) << "%\n";
+    std::cout << "Max absolute error:  " << max_error << "%\n";
+    std::cout << "=========================\n\n";
+}
@@ -0,0 +1,87 @@
+#include "tag_match.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define TAG_MATCH_X86 1
+#include <immintrin.h>
+static_assert(sizeof(size_t) == sizeof(long long), "tags must be 64-bit for the SIMD kernels");
+#endif
+
+typedef uint64_t (*MatchKernel)(const size_t*, size_t, size_t);
+
+static uint64_t matchScalar(const size_t* tags, size_t count, size_t probe) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        mask |= (uint64_t)(tags[i] == probe) << i;
+    }
+    return mask;
+}
+
+#ifdef TAG_MATCH_X86
+
+__attribute__((target("avx2")))
+static uint64_t matchAvx2(const size_t* tags, size_t count, size_t probe) {
+    __m256i key = _mm256_set1_epi64x((long long)probe);
+    uint64_t mask = 0;
+    size_t i = 0;
+    
+    // Four ways per compare; movemask packs the lane results into bits
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(tags + i));
+        __m256i eq = _mm256_cmpeq_epi64(v, key);
+        mask |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(eq)) << i;
+    }
+    for (; i < count; i++) {
+        mask |= (uint64_t)(tags[i] == probe) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("sse4.1")))
+static uint64_t matchSse41(const size_t* tags, size_t count, size_t probe) {
+    __m128i key = _mm_set1_epi64x((long long)probe);
+    uint64_t mask = 0;
+    size_t i = 0;
+    
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(tags + i));
+        __m128i eq = _mm_cmpeq_epi64(v, key);
+        mask |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+    }
+    for (; i < count; i++) {
+        mask |= (uint64_t)(tags[i] == probe) << i;
+    }
+    return mask;
+}
+
+#endif // TAG_MATCH_X86
+
+struct KernelChoice {
+    MatchKernel fn;
+    const char* name;
+};
+
+static KernelChoice selectKernel() {
+#ifdef TAG_MATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {matchAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return {matchSse41, "sse4.1"};
+    }
+#endif
+    return {matchScalar, "scalar"};
+}
+
+static const KernelChoice& kernel() {
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+uint64_t matchTags(const size_t* tags, size_t count, size_t probe) {
+    return kernel().fn(tags, count, probe);
+}
+
+const char* tagMatchKernel() {
+    return kernel().name;
+}
@@ -0,0 +1,129 @@
+#include "trace.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Parse one text trace line; false for lines that are not a reference
+static bool parseTraceLine(const std::string& line, TraceRecord& record) {
+    std::istringstream iss(line);
+    std::string op, address;
+    iss >> op;
+    if (op == "cache") {
+        iss >> op;
+    }
+    if (op != "read" && op != "write" && op != "access") {
+        return false;
+    }
+    if (!(iss >> address)) {
+        return false;
+    }
+    
+    try {
+        record.address = std::stoull(address, nullptr, 0);  // Supports hex
+        record.is_write = (op == "write");
+    } catch (...) {
+        return false;  // Not an address, skip the line
+    }
+    return true;
+}
+
+bool loadTextTrace(const std::string& path, std::vector<TraceRecord>& records) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Error: Cannot open trace file '" << path << "'\n";
+        return false;
+    }
+    
+    std::string line;
+    TraceRecord record;
+    while (std::getline(file, line)) {
+        if (parseTraceLine(line, record)) {
+            records.push_back(record);
+        }
+    }
+    return true;
+}
+
+// ============ TextTraceReader Implementation ============
+
+bool TextTraceReader::open(const std::string& path) {
+    file.close();
+    file.clear();
+    file.open(path);
+    if (!file) {
+        std::cout << "Error: Cannot open trace file '" << path << "'\n";
+        return false;
+    }
+    return true;
+}
+
+size_t TextTraceReader::read(TraceRecord* records, size_t max) {
+    size_t count = 0;
+    std::string line;
+    while (count < max && std::getline(file, line)) {
+        if (parseTraceLine(line, records[count])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// ============ MappedTrace Implementation ============
+
+MappedTrace::MappedTrace() : data(nullptr), length(0), count(0) {}
+
+MappedTrace::~MappedTrace() {
+    close();
+}
+
+bool MappedTrace::open(const std::string& path) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Error: Cannot open trace file '" << path << "'\n";
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        std::cout << "Error: Cannot read size of trace file '" << path << "'\n";
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size % sizeof(uint64_t) != 0) {
+        std::cout << "Error: Trace file '" << path << "' is not a whole number of 8-byte records\n";
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        ::close(fd);
+        return true;  // Nothing to map
+    }
+    
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        std::cout << "Error: Cannot map trace file '" << path << "'\n";
+        return false;
+    }
+    madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+    
+    data = static_cast<const uint64_t*>(mapped);
+    length = info.st_size;
+    count = length / sizeof(uint64_t);
+    return true;
+}
+
+void MappedTrace::close() {
+    if (data != nullptr) {
+        munmap(const_cast<uint64_t*>(data), length);
+    }
+    data = nullptr;
+    length = 0;
+    count = 0;
+}
@@ -2,11 +2,12 @@
  * Memory Management Simulator
  * 
  * A comprehensive simulator for OS memory management concepts including:
- * - Dynamic memory allocation (First Fit, Best Fit, Worst Fit)
+ * - Dynamic memory allocation (First/Best/Worst/Next Fit, TLSF, Buddy)
  * - Multilevel cache simulation (L1, L2)
  * - Statistics and fragmentation metrics
  * 
- * Usage: ./memsim
+ * Usage: ./memsim [--quiet] [--cache-trace <file.bin> [--threads <n>]
+ *                            [--sweep <configs>]]
  * Type 'help' for available commands
  */
 
@@ -15,11 +16,28 @@
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
 
 #include "allocator.h"
 #include "cache.h"
+#include "trace.h"
+#include "stack_distance.h"
+#include "cache_sweep.h"
+#include "tag_match.h"
 using namespace std;
 
+// Names accepted by parsePolicy, for the init cache prompts
+static const char* POLICY_NAMES = "fifo/lru/plru/bitplru/srrip/brrip/drrip/opt";
+
+// Print an interactive prompt unless the REPL is quiet
+void prompt(bool quiet, const std::string& text) {
+    if (!quiet) {
+        std::cout << text;
+    }
+}
+
 // Helper function to split string by spaces
 std::vector<std::string> splitCommand(const std::string& line) {
     std::vector<std::string> tokens;
@@ -36,24 +54,51 @@ void printHelp() {
 === Memory Management Simulator - Help ===
 
 MEMORY COMMANDS:
-  init memory <size>         Initialize physical memory (in bytes)
+  init memory <size> [backend]
+                             Initialize physical memory (in bytes)
+                             Backend: list (default) or table
   set allocator <strategy>   Set allocation strategy:
                               - first_fit
                               - best_fit  
                               - worst_fit
+                              - next_fit
+                              - tlsf
+                              - buddy
   malloc <size>              Allocate memory block of given size
   free <id>                  Free memory block by its ID
   dump memory                Display current memory state
   stats                      Show memory statistics
+  set verbose <on|off>       Turn prompts and per-operation output on/off
+                             (when off, stats are printed at exit)
 
 CACHE COMMANDS:
   init cache                 Initialize cache hierarchy (interactive config)
+                             Policies: lru, fifo, plru (tree), bitplru,
+                             srrip, brrip, drrip, opt (needs a trace)
   cache read <address>       Read from memory address through cache
   cache write <address>      Write to memory address (sets dirty bit)
   cache access <address>     Alias for 'cache read'
   cache stats                Show cache hit/miss statistics
   cache config               Show cache configuration
   cache reset                Reset cache statistics
+  cache trace <file> [threads]
+                             Replay a text trace of read/write lines
+                             without per-access output; with threads > 1
+                             the sets of an L1-only cache are split
+                             between threads (L2 size 0 = no L2)
+  cache mrc <file> [block] [rate <r> | size <n>]
+                             LRU miss ratio of every cache size in one pass
+                             over a text trace, or a binary trace if the
+                             file ends in .bin (block size default 16);
+                             'rate' samples that fraction of the blocks,
+                             'size' at most n blocks (SHARDS)
+  cache mrc-accuracy <file> [block] rate <r> | size <n>
+                             Compare a sampled curve with the exact one
+  cache sweep <configs> <file> [threads]
+                             Simulate each hierarchy in <configs> (one per
+                             line, levels as 'size block assoc policy
+                             latency' separated by '/') over a text trace
+                             on a thread pool and print CSV
 
 GENERAL:
   help                       Show this help message
@@ -73,6 +118,160 @@ EXAMPLES:
 )";
 }
 
+void printMemoryStats(const Allocator& allocator) {
+    if (!allocator.isInitialized()) {
+        std::cout << "Memory not initialized\n";
+    } else {
+        AllocationStats stats = allocator.getStats();
+        std::cout << "\n=== Memory Statistics ===\n";
+        std::cout << "Allocator:              " << allocator.getStrategyName() << "\n";
+        std::cout << "Total memory:           " << stats.total_memory << " bytes\n";
+        std::cout << "Used memory:            " << stats.used_memory << " bytes\n";
+        std::cout << "Free memory:            " << stats.free_memory << " bytes\n";
+        std::cout << "Memory utilization:     " << std::fixed << std::setprecision(1)
+                  << (stats.total_memory > 0 ? (double)stats.used_memory / stats.total_memory * 100 : 0)
+                  << "%\n";
+        std::cout << "Allocations:            " << stats.num_allocations << "\n";
+        std::cout << "Deallocations:          " << stats.num_deallocations << "\n";
+        std::cout << "Allocation failures:    " << stats.allocation_failures << "\n";
+        std::cout << "External fragmentation: " << std::fixed << std::setprecision(1)
+                  << stats.external_fragmentation << "%\n";
+        std::cout << "Internal fragmentation: " << std::fixed << std::setprecision(1)
+                  << stats.internal_fragmentation << "%\n";
+        std::cout << "Node pool high-water:   " << stats.node_pool_high_water << " blocks\n";
+        std::cout << "=========================\n\n";
+    }
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  -q, --quiet    No prompts or per-operation output; print stats at exit\n"
+              << "  --cache-trace <file.bin>\n"
+              << "                 Replay a binary trace (8-byte records, bit 63 = write)\n"
+              << "                 through the default cache hierarchy and exit\n"
+              << "  --threads <n>  With --cache-trace: simulate the default L1 alone, with\n"
+              << "                 its sets split between n threads (n = 1 is the\n"
+              << "                 serial reference for the same hierarchy)\n"
+              << "  --sweep <configs>\n"
+              << "                 With --cache-trace: simulate every hierarchy in the\n"
+              << "                 config file (one per line) on a pool of --threads\n"
+              << "                 threads (default: all cores) and print CSV\n"
+              << "  -h, --help     Show this message\n";
+}
+
+// Run stack-distance analyzers over a trace file a chunk at a time, so
+// the trace never has to fit in memory. Files ending in ".bin" are
+// memory-mapped binary traces, anything else is read as a text trace.
+bool analyzeTraceFile(const std::string& path, const std::vector<StackDistanceAnalyzer*>& analyzers) {
+    const size_t CHUNK = 4096;
+    std::vector<TraceRecord> chunk(CHUNK);
+    bool binary = path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    MappedTrace mapped;
+    TextTraceReader text;
+    if (binary ? !mapped.open(path) : !text.open(path)) {
+        return false;
+    }
+    
+    for (StackDistanceAnalyzer* analyzer : analyzers) {
+        analyzer->begin();
+    }
+    size_t position = 0;
+    while (true) {
+        size_t n;
+        if (binary) {
+            n = mapped.size() - position < CHUNK ? mapped.size() - position : CHUNK;
+            for (size_t i = 0; i < n; i++) {
+                chunk[i] = decodeTraceRecord(mapped.records()[position + i]);
+            }
+            position += n;
+        } else {
+            n = text.read(chunk.data(), CHUNK);
+        }
+        if (n == 0) break;
+        for (StackDistanceAnalyzer* analyzer : analyzers) {
+            analyzer->feed(chunk.data(), n);
+        }
+    }
+    for (StackDistanceAnalyzer* analyzer : analyzers) {
+        analyzer->finish();
+    }
+    return true;
+}
+
+// Decode a memory-mapped binary trace once and sweep the configurations
+// in 'config_path' over it, writing CSV to stdout
+int sweepBinaryTrace(const std::string& path, const std::string& config_path, size_t threads) {
+    std::vector<SweepConfig> configs;
+    if (!loadSweepConfigs(config_path, configs)) {
+        return 1;
+    }
+    
+    MappedTrace mapped;
+    if (!mapped.open(path)) {
+        return 1;
+    }
+    std::vector<TraceRecord> trace(mapped.size());
+    for (size_t i = 0; i < mapped.size(); i++) {
+        trace[i] = decodeTraceRecord(mapped.records()[i]);
+    }
+    mapped.close();
+    
+    runSweep(configs, trace, threads, std::cout);
+    return 0;
+}
+
+// Replay a memory-mapped binary trace through the default 'init cache'
+// hierarchy, decoding it in chunks so it never has to fit in memory.
+// With a thread count (0 = not given) the default L1 is simulated alone,
+// sharded by set, so one thread gives the serial reference for n.
+int replayBinaryTrace(const std::string& path, size_t threads) {
+    MappedTrace trace;
+    if (!trace.open(path)) {
+        return 1;
+    }
+    
+    CacheSimulator cacheSimulator;
+    cacheSimulator.addLevel("L1", 256, 16, 4, ReplacementPolicy::LRU, 1);
+    if (threads == 0) {
+        cacheSimulator.addLevel("L2", 1024, 32, 8, ReplacementPolicy::FIFO, 10);
+    }
+    
+    // Bigger chunks in parallel so starting the threads is amortised
+    const size_t CHUNK = (threads <= 1) ? 4096 : 1 << 20;
+    std::vector<TraceRecord> chunk(CHUNK);
+    const uint64_t* raw = trace.records();
+    size_t memory_accesses = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < trace.size(); first += CHUNK) {
+        size_t n = trace.size() - first < CHUNK ? trace.size() - first : CHUNK;
+        for (size_t i = 0; i < n; i++) {
+            chunk[i] = decodeTraceRecord(raw[first + i]);
+        }
+        if (threads <= 1) {
+            memory_accesses += cacheSimulator.accessBatch(chunk.data(), n).memory_accesses;
+        } else {
+            BatchResult result;
+            cacheSimulator.accessBatchParallel(chunk.data(), n, threads, result);
+            memory_accesses += result.memory_accesses;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    cacheSimulator.printStats();
+    std::cout << "Replayed " << trace.size() << " accesses from " << path
+              << " (" << memory_accesses << " from memory) in "
+              << std::fixed << std::setprecision(3) << seconds << " s";
+    if (threads > 0) {
+        std::cout << " on " << threads << (threads == 1 ? " thread" : " threads");
+    }
+    if (seconds > 0) {
+        std::cout << ", " << std::setprecision(0) << trace.size() / seconds << " accesses/sec";
+    }
+    std::cout << "\nTag matching: " << tagMatchKernel() << "\n";
+    return 0;
+}
+
 void printBanner() {
     std::cout << R"(
 ╔══════════════════════════════════════════════════════════╗
@@ -84,15 +283,70 @@ Type 'help' for available commands.
 )";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     Allocator allocator;
     CacheSimulator cacheSimulator;
     
-    printBanner();
+    std::string trace_path;
+    std::string sweep_path;
+    size_t trace_threads = 0;  // Not given
+    
+    // Quiet REPL: no banner, prompts or per-operation output, and the
+    // statistics printed once at exit
+    bool quiet = false;
+    auto setQuiet = [&](bool on) {
+        quiet = on;
+        allocator.setVerbose(!on);
+        cacheSimulator.setVerbose(!on);
+    };
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-q" || arg == "--quiet") {
+            setQuiet(true);
+        } else if (arg == "--cache-trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            sweep_path = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            trace_threads = std::strtoull(argv[++i], nullptr, 10);
+            if (trace_threads == 0) {
+                std::cout << "Invalid thread count: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cout << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (!sweep_path.empty()) {
+        if (trace_path.empty()) {
+            std::cout << "--sweep needs a trace: --cache-trace <file.bin>\n";
+            return 1;
+        }
+        if (trace_threads == 0) {
+            trace_threads = std::thread::hardware_concurrency();
+        }
+        return sweepBinaryTrace(trace_path, sweep_path, trace_threads);
+    }
+    if (!trace_path.empty()) {
+        return replayBinaryTrace(trace_path, trace_threads);
+    }
+    
+    if (!quiet) {
+        printBanner();
+    }
     
     std::string line;
     while (true) {
-        std::cout << "> ";
+        if (!quiet) {
+            std::cout << "> ";
+        }
         if (!std::getline(std::cin, line)) {
             break;
         }
@@ -104,7 +358,9 @@ int main() {
         
         // ===== EXIT =====
         if (cmd == "exit" || cmd == "quit") {
-            std::cout << "Goodbye!\n";
+            if (!quiet) {
+                std::cout << "Goodbye!\n";
+            }
             break;
         }
         
@@ -120,76 +376,108 @@ int main() {
         
         // ===== INIT MEMORY =====
         else if (cmd == "init" && tokens.size() >= 3 && tokens[1] == "memory") {
-            try {
-                size_t size = std::stoull(tokens[2]);
-                allocator.initMemory(size);
-            } catch (...) {
-                std::cout << "Error: Invalid size\n";
+            BlockBackend backend = BlockBackend::LIST;
+            bool valid_backend = true;
+            if (tokens.size() >= 4) {
+                if (tokens[3] == "table") {
+                    backend = BlockBackend::TABLE;
+                } else if (tokens[3] != "list") {
+                    std::cout << "Unknown backend: " << tokens[3] << "\n";
+                    std::cout << "Available: list, table\n";
+                    valid_backend = false;
+                }
+            }
+            if (valid_backend) {
+                try {
+                    size_t size = std::stoull(tokens[2]);
+                    allocator.initMemory(size, backend);
+                } catch (...) {
+                    std::cout << "Error: Invalid size\n";
+                }
             }
         }
         
         // ===== INIT CACHE =====
         else if (cmd == "init" && tokens.size() >= 2 && tokens[1] == "cache") {
             // Interactive cache configuration
-            std::cout << "\n=== Cache Configuration ===\n";
+            prompt(quiet, "\n=== Cache Configuration ===\n");
             
             // --- L1 Cache ---
-            std::cout << "\n-- L1 Cache --\n";
+            prompt(quiet, "\n-- L1 Cache --\n");
             size_t l1_size, l1_block, l1_assoc, l1_latency;
             std::string l1_policy_str;
             
-            std::cout << "  Size (bytes) [default 256]: ";
+            prompt(quiet, "  Size (bytes) [default 256]: ");
             std::getline(std::cin, line);
             l1_size = line.empty() ? 256 : std::stoull(line);
             
-            std::cout << "  Block size (bytes) [default 16]: ";
+            prompt(quiet, "  Block size (bytes) [default 16]: ");
             std::getline(std::cin, line);
             l1_block = line.empty() ? 16 : std::stoull(line);
             
-            std::cout << "  Associativity [default 4]: ";
+            prompt(quiet, "  Associativity [default 4]: ");
             std::getline(std::cin, line);
             l1_assoc = line.empty() ? 4 : std::stoull(line);
             
-            std::cout << "  Replacement policy (lru/fifo) [default lru]: ";
+            prompt(quiet, std::string("  Replacement policy (") + POLICY_NAMES + ") [default lru]: ");
             std::getline(std::cin, line);
             l1_policy_str = line.empty() ? "lru" : line;
-            ReplacementPolicy l1_policy = (l1_policy_str == "fifo") ? ReplacementPolicy::FIFO : ReplacementPolicy::LRU;
+            ReplacementPolicy l1_policy = ReplacementPolicy::LRU;
+            if (!parsePolicy(l1_policy_str, l1_policy)) {
+                std::cout << "  Unknown policy: " << l1_policy_str << ", using lru\n";
+            }
             
-            std::cout << "  Access latency (cycles) [default 1]: ";
+            prompt(quiet, "  Access latency (cycles) [default 1]: ");
             std::getline(std::cin, line);
             l1_latency = line.empty() ? 1 : std::stoull(line);
             
             // --- L2 Cache ---
-            std::cout << "\n-- L2 Cache --\n";
+            prompt(quiet, "\n-- L2 Cache --\n");
             size_t l2_size, l2_block, l2_assoc, l2_latency;
             std::string l2_policy_str;
             
-            std::cout << "  Size (bytes) [default 1024]: ";
+            prompt(quiet, "  Size (bytes) [default 1024]: ");
             std::getline(std::cin, line);
             l2_size = line.empty() ? 1024 : std::stoull(line);
             
-            std::cout << "  Block size (bytes) [default 32]: ";
+            prompt(quiet, "  Block size (bytes) [default 32]: ");
             std::getline(std::cin, line);
             l2_block = line.empty() ? 32 : std::stoull(line);
             
-            std::cout << "  Associativity [default 8]: ";
+            prompt(quiet, "  Associativity [default 8]: ");
             std::getline(std::cin, line);
             l2_assoc = line.empty() ? 8 : std::stoull(line);
             
-            std::cout << "  Replacement policy (lru/fifo) [default fifo]: ";
+            prompt(quiet, std::string("  Replacement policy (") + POLICY_NAMES + ") [default fifo]: ");
             std::getline(std::cin, line);
             l2_policy_str = line.empty() ? "fifo" : line;
-            ReplacementPolicy l2_policy = (l2_policy_str == "lru") ? ReplacementPolicy::LRU : ReplacementPolicy::FIFO;
+            ReplacementPolicy l2_policy = ReplacementPolicy::FIFO;
+            if (!parsePolicy(l2_policy_str, l2_policy)) {
+                std::cout << "  Unknown policy: " << l2_policy_str << ", using fifo\n";
+            }
             
-            std::cout << "  Access latency (cycles) [default 10]: ";
+            prompt(quiet, "  Access latency (cycles) [default 10]: ");
             std::getline(std::cin, line);
             l2_latency = line.empty() ? 10 : std::stoull(line);
             
-            // Add the configured levels
-            std::cout << "\n";
-            cacheSimulator.addLevel("L1", l1_size, l1_block, l1_assoc, l1_policy, l1_latency);
-            cacheSimulator.addLevel("L2", l2_size, l2_block, l2_assoc, l2_policy, l2_latency);
-            std::cout << "Cache hierarchy initialized (Memory latency: 100 cycles)\n";
+            // Reject the whole hierarchy if either level is invalid
+            prompt(quiet, "\n");
+            std::string error;
+            if (!CacheLevel::validateGeometry(l1_size, l1_block, l1_assoc, l1_policy, error)) {
+                std::cout << "Error: Invalid L1 configuration: " << error << "\n";
+            } else if (l2_size != 0 &&
+                       !CacheLevel::validateGeometry(l2_size, l2_block, l2_assoc, l2_policy, error)) {
+                std::cout << "Error: Invalid L2 configuration: " << error << "\n";
+            } else {
+                // Add the configured levels (an L2 size of 0 means L1 only)
+                cacheSimulator.addLevel("L1", l1_size, l1_block, l1_assoc, l1_policy, l1_latency);
+                if (l2_size != 0) {
+                    cacheSimulator.addLevel("L2", l2_size, l2_block, l2_assoc, l2_policy, l2_latency);
+                }
+                if (!quiet) {
+                    std::cout << "Cache hierarchy initialized (Memory latency: 100 cycles)\n";
+                }
+            }
         }
         
         // ===== SET ALLOCATOR =====
@@ -197,6 +485,17 @@ int main() {
             allocator.setStrategy(tokens[2]);
         }
         
+        // ===== SET VERBOSE =====
+        else if (cmd == "set" && tokens.size() >= 3 && tokens[1] == "verbose") {
+            if (tokens[2] == "on") {
+                setQuiet(false);
+            } else if (tokens[2] == "off") {
+                setQuiet(true);
+            } else {
+                std::cout << "Usage: set verbose <on|off>\n";
+            }
+        }
+        
         // ===== MALLOC =====
         else if (cmd == "malloc" && tokens.size() >= 2) {
             if (!allocator.isInitialized()) {
@@ -228,25 +527,7 @@ int main() {
         
         // ===== STATS =====
         else if (cmd == "stats") {
-            if (!allocator.isInitialized()) {
-                std::cout << "Memory not initialized\n";
-            } else {
-                AllocationStats stats = allocator.getStats();
-                std::cout << "\n=== Memory Statistics ===\n";
-                std::cout << "Allocator:              " << allocator.getStrategyName() << "\n";
-                std::cout << "Total memory:           " << stats.total_memory << " bytes\n";
-                std::cout << "Used memory:            " << stats.used_memory << " bytes\n";
-                std::cout << "Free memory:            " << stats.free_memory << " bytes\n";
-                std::cout << "Memory utilization:     " << std::fixed << std::setprecision(1)
-                          << (stats.total_memory > 0 ? (double)stats.used_memory / stats.total_memory * 100 : 0)
-                          << "%\n";
-                std::cout << "Allocations:            " << stats.num_allocations << "\n";
-                std::cout << "Deallocations:          " << stats.num_deallocations << "\n";
-                std::cout << "Allocation failures:    " << stats.allocation_failures << "\n";
-                std::cout << "External fragmentation: " << std::fixed << std::setprecision(1)
-                          << stats.external_fragmentation << "%\n";
-                std::cout << "=========================\n\n";
-            }
+            printMemoryStats(allocator);
         }
         
         // ===== CACHE READ =====
@@ -256,7 +537,9 @@ int main() {
             } else {
                 try {
                     size_t address = std::stoull(tokens[2], nullptr, 0);  // Supports hex
-                    std::cout << "Reading address: 0x" << std::hex << address << std::dec << "\n";
+                    if (!quiet) {
+                        std::cout << "Reading address: 0x" << std::hex << address << std::dec << "\n";
+                    }
                     cacheSimulator.access(address, false);  // isWrite = false
                 } catch (...) {
                     std::cout << "Error: Invalid address\n";
@@ -271,7 +554,9 @@ int main() {
             } else {
                 try {
                     size_t address = std::stoull(tokens[2], nullptr, 0);  // Supports hex
-                    std::cout << "Writing address: 0x" << std::hex << address << std::dec << "\n";
+                    if (!quiet) {
+                        std::cout << "Writing address: 0x" << std::hex << address << std::dec << "\n";
+                    }
                     cacheSimulator.access(address, true);  // isWrite = true
                 } catch (...) {
                     std::cout << "Error: Invalid address\n";
@@ -297,6 +582,126 @@ int main() {
             }
         }
         
+        // ===== CACHE TRACE =====
+        else if (cmd == "cache" && tokens.size() >= 3 && tokens[1] == "trace") {
+            if (!cacheSimulator.isInitialized()) {
+                std::cout << "Error: Cache not initialized. Use 'init cache' first.\n";
+            } else {
+                // Optional thread count: shard the sets of a single-level cache
+                size_t threads = 1;
+                if (tokens.size() >= 4) {
+                    try {
+                        threads = std::stoull(tokens[3]);
+                    } catch (...) {
+                        threads = 0;
+                    }
+                }
+                
+                std::vector<TraceRecord> trace;
+                BatchResult result;
+                bool replayed = false;
+                if (threads == 0) {
+                    std::cout << "Error: Invalid thread count\n";
+                } else if (loadTextTrace(tokens[2], trace)) {
+                    if (threads == 1) {
+                        result = cacheSimulator.runTrace(trace);
+                        replayed = true;
+                    } else {
+                        replayed = cacheSimulator.runTraceParallel(trace, threads, result);
+                    }
+                }
+                if (replayed) {
+                    std::cout << "Replayed " << result.accesses << " accesses from " << tokens[2]
+                              << " (" << result.memory_accesses << " from memory, "
+                              << std::fixed << std::setprecision(2) << result.averageCycles()
+                              << " cycles average)\n";
+                }
+            }
+        }
+        
+        // ===== CACHE MRC =====
+        else if (cmd == "cache" && tokens.size() >= 3 &&
+                 (tokens[1] == "mrc" || tokens[1] == "mrc-accuracy")) {
+            // cache mrc[-accuracy] <file> [block] [rate <r> | size <n>]
+            size_t block_size = 16;
+            std::string sampling;
+            double rate = 0;
+            size_t max_blocks = 0;
+            bool valid = true;
+            try {
+                size_t next = 3;
+                if (tokens.size() > next && tokens[next] != "rate" && tokens[next] != "size") {
+                    block_size = std::stoull(tokens[next++]);
+                }
+                if (tokens.size() >= next + 2) {
+                    sampling = tokens[next];
+                    if (sampling == "rate") {
+                        rate = std::stod(tokens[next + 1]);
+                        valid = rate > 0 && rate <= 1;
+                    } else if (sampling == "size") {
+                        max_blocks = std::stoull(tokens[next + 1]);
+                        valid = max_blocks > 0;
+                    } else {
+                        valid = false;
+                    }
+                } else if (tokens.size() > next) {
+                    valid = false;
+                }
+            } catch (...) {
+                valid = false;
+            }
+            
+            if (!valid) {
+                std::cout << "Error: Usage: cache " << tokens[1]
+                          << " <file> [block] [rate <0-1> | size <blocks>]\n";
+            } else if (block_size == 0 || (block_size & (block_size - 1)) != 0) {
+                std::cout << "Error: Block size must be a power of two\n";
+            } else if (tokens[1] == "mrc-accuracy" && sampling.empty()) {
+                std::cout << "Error: mrc-accuracy needs 'rate <r>' or 'size <n>'\n";
+            } else {
+                StackDistanceAnalyzer analyzer(block_size);
+                if (sampling == "rate") {
+                    analyzer.setFixedRate(rate);
+                } else if (sampling == "size") {
+                    analyzer.setFixedSize(max_blocks);
+                }
+                
+                // The exact curve for mrc-accuracy comes from the same pass
+                StackDistanceAnalyzer exact(block_size);
+                std::vector<StackDistanceAnalyzer*> analyzers(1, &analyzer);
+                if (tokens[1] == "mrc-accuracy") {
+                    analyzers.push_back(&exact);
+                }
+                if (analyzeTraceFile(tokens[2], analyzers)) {
+                    if (tokens[1] == "mrc") {
+                        analyzer.printCurve();
+                    } else {
+                        printSamplingAccuracy(exact, analyzer);
+                    }
+                }
+            }
+        }
+        
+        // ===== CACHE SWEEP =====
+        else if (cmd == "cache" && tokens.size() >= 4 && tokens[1] == "sweep") {
+            size_t threads = std::thread::hardware_concurrency();
+            if (tokens.size() >= 5) {
+                try {
+                    threads = std::stoull(tokens[4]);
+                } catch (...) {
+                    threads = 0;
+                }
+            }
+            
+            std::vector<SweepConfig> configs;
+            std::vector<TraceRecord> trace;
+            if (threads == 0 && tokens.size() >= 5) {
+                std::cout << "Error: Invalid thread count\n";
+            } else if (loadSweepConfigs(tokens[2], configs) && loadTextTrace(tokens[3], trace)) {
+                runSweep(configs, trace, threads, std::cout);
+            }
+        }
+        
         // ===== CACHE RESET =====
         else if (cmd == "cache" && tokens.size() >= 2 && tokens[1] == "reset") {
             cacheSimulator.resetStats();
@@ -309,5 +714,15 @@ int main() {
         }
     }
     
+    // In quiet mode only the aggregate statistics are reported
+    if (quiet) {
+        if (allocator.isInitialized()) {
+            printMemoryStats(allocator);
+        }
+        if (cacheSimulator.isInitialized()) {
+            cacheSimulator.printStats();
+        }
+    }
+    
     return 0;
 }